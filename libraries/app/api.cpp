@@ -275,18 +275,16 @@ namespace graphene { namespace app {
             } case proposal_object_type:{
                const auto& aobj = dynamic_cast<const proposal_object*>(obj);
                assert( aobj != nullptr );
-               flat_set<account_id_type> impacted;
+               impacted_accounts_buffer impacted;
                transaction_get_impacted_accounts( aobj->proposed_transaction, impacted );
-               result.reserve( impacted.size() );
-               for( auto& item : impacted ) result.emplace_back(item);
+               result.insert( result.end(), impacted.begin(), impacted.end() );
                break;
             } case operation_history_object_type:{
                const auto& aobj = dynamic_cast<const operation_history_object*>(obj);
                assert( aobj != nullptr );
-               flat_set<account_id_type> impacted;
-               operation_get_impacted_accounts( aobj->op, impacted );
-               result.reserve( impacted.size() );
-               for( auto& item : impacted ) result.emplace_back(item);
+               impacted_accounts_buffer impacted;
+               operation_get_impacted_accounts( aobj->op.to_operation(), impacted );
+               result.insert( result.end(), impacted.begin(), impacted.end() );
                break;
             } case withdraw_permission_object_type:{
                const auto& aobj = dynamic_cast<const withdraw_permission_object*>(obj);
@@ -347,10 +345,9 @@ namespace graphene { namespace app {
                } case impl_transaction_object_type:{
                   const auto& aobj = dynamic_cast<const transaction_object*>(obj);
                   assert( aobj != nullptr );
-                  flat_set<account_id_type> impacted;
+                  impacted_accounts_buffer impacted;
                   transaction_get_impacted_accounts( aobj->trx, impacted );
-                  result.reserve( impacted.size() );
-                  for( auto& item : impacted ) result.emplace_back(item);
+                  result.insert( result.end(), impacted.begin(), impacted.end() );
                   break;
                } case impl_blinded_balance_object_type:{
                   const auto& aobj = dynamic_cast<const blinded_balance_object*>(obj);
@@ -443,6 +440,9 @@ namespace graphene { namespace app {
                                                                        unsigned limit,
                                                                        operation_history_id_type start ) const
     {
+       if( auto store = async_history() )
+          return store->get_account_history( account, stop, limit, start,
+                                             [](const operation_history_object&) { return true; } );
        return get_account_history_impl(account,
                                        [](const account_transaction_history_object*) { return true; },
                                        stop,
@@ -456,6 +456,10 @@ namespace graphene { namespace app {
                                                                       unsigned limit,
                                                                       operation_history_id_type start) const
     {
+       if( auto store = async_history() )
+          return store->get_account_history( account, stop, limit, start,
+                                             [&operation_types](const operation_history_object& op) {
+                                                 return operation_types.find(op.op.which()) != operation_types.end(); } );
        FC_ASSERT( _app.chain_database() );
        const auto& db = *_app.chain_database();
        return get_account_history_impl(account,
@@ -471,6 +475,8 @@ namespace graphene { namespace app {
                                                                                 unsigned limit,
                                                                                 uint32_t start) const
     {
+       if( auto store = async_history() )
+          return store->get_relative_account_history( account, stop, limit, start );
        FC_ASSERT( _app.chain_database() );
        const auto& db = *_app.chain_database();
        FC_ASSERT(limit <= 100);
@@ -494,6 +500,21 @@ namespace graphene { namespace app {
        return result;
     }
 
+    uint32_t history_api::get_account_history_block_num()const
+    {
+       if( auto store = async_history() )
+          return store->indexed_block_num();
+       FC_ASSERT( _app.chain_database() );
+       return _app.chain_database()->head_block_num();
+    }
+
+    const graphene::account_history::sharded_history_store* history_api::async_history()const
+    {
+       auto plugin = std::dynamic_pointer_cast<graphene::account_history::account_history_plugin>(
+                         _app.get_plugin( "account_history" ) );
+       return plugin ? plugin->async_history() : nullptr;
+    }
+
     flat_set<uint32_t> history_api::get_market_history_buckets()const
     {
        auto hist = _app.get_plugin<market_history_plugin>( "market_history" );
@@ -377,6 +377,9 @@ namespace detail {
          if( _options->count("replay-blockchain") )
             _chain_db->wipe( _data_dir / "blockchain", false );
 
+         if( _options->count("enable-account-name-search") && _options->at("enable-account-name-search").as<bool>() )
+            _chain_db->enable_account_name_search();
+
          try
          {
             _chain_db->open( _data_dir / "blockchain", initial_state, GRAPHENE_CURRENT_DB_VERSION );
@@ -387,6 +390,9 @@ namespace detail {
             throw;
          }
 
+         if( _options->count("undo-max-memory") )
+            _chain_db->_undo_db.set_max_memory( _options->at("undo-max-memory").as<uint64_t>() * 1024 * 1024 );
+
          if( _options->count("force-validate") )
          {
             ilog( "All transaction signatures will be validated" );
@@ -923,6 +929,8 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from")
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
+         ("undo-max-memory", bpo::value<uint64_t>(), "Memory in MiB above which older undo history is kept packed, 0 or unset for no limit")
+         ("enable-account-name-search", bpo::value<bool>()->default_value(false), "Maintain an index of account names for the search_accounts API")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
@@ -32,6 +32,7 @@
 
 #include <fc/bloom_filter.hpp>
 #include <fc/smart_ref_impl.hpp>
+#include <fc/thread/thread.hpp>
 
 #include <fc/crypto/hex.hpp>
 #include <fc/uint128.hpp>
@@ -40,6 +41,7 @@
 #include <boost/rational.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 
+#include <array>
 #include <cctype>
 #include <cmath>
 
@@ -53,6 +55,7 @@ namespace graphene { namespace app {
 typedef std::map< std::pair<graphene::chain::asset_id_type, graphene::chain::asset_id_type>, std::vector<fc::variant> > market_queue_type;
 
 class database_api_impl;
+class notification_fanout;
 
 
 class database_api_impl : public std::enable_shared_from_this<database_api_impl>
@@ -85,6 +88,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       fc::variant_object get_config()const;
       chain_id_type get_chain_id()const;
       dynamic_global_property_object get_dynamic_global_properties()const;
+      undo_stats get_undo_history_stats()const;
+      block_production_stats get_block_production_stats()const;
       optional<total_cycles_res> get_total_cycles() const;
 
       // Keys
@@ -97,6 +102,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<account_id_type> get_account_references( account_id_type account_id )const;
       vector<optional<account_object>> lookup_account_names(const vector<string>& account_names)const;
       map<string,account_id_type> lookup_accounts(const string& lower_bound_name, uint32_t limit)const;
+      vector<pair<string,account_id_type>> search_accounts(const string& query, account_id_type start, uint32_t limit)const;
       uint64_t get_account_count()const;
 
       // Balances
@@ -117,6 +123,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       optional<issued_asset_record_object> get_issued_asset_record(const string& unique_id, asset_id_type asset_id) const;
       bool check_issued_asset(const string& unique_id, const string& asset) const;
       bool check_issued_webeur(const string& unique_id) const;
+      vector<string> check_issued_assets(const vector<string>& unique_ids, const string& asset) const;
+      vector<string> check_issued_webeurs(const vector<string>& unique_ids) const;
 
       // Markets / feeds
       vector<limit_order_object>         get_limit_orders(asset_id_type a, asset_id_type b, uint32_t limit)const;
@@ -227,6 +235,28 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
          }
       }
 
+      /**
+       *  subscribe_to_item for many object ids, reusing one pack buffer and without logging each.  The bloom filter
+       *  has no bulk insert, so every id is still added on its own.
+       */
+      void subscribe_to_objects( const vector<object_id_type>& ids )const
+      {
+         if( !_subscribe_callback )
+            return;
+
+         std::array<char, sizeof(uint64_t)> buffer;
+         for( const auto& id : ids )
+         {
+            if( id.type() == operation_history_object_type && id.space() == protocol_ids ) continue;
+            if( id.type() == impl_account_transaction_history_object_type && id.space() == implementation_ids ) continue;
+            if( _subscribe_filter.contains( id ) ) continue;
+
+            fc::datastream<char*> ds( buffer.data(), buffer.size() );
+            fc::raw::pack( ds, id );
+            _subscribe_filter.insert( buffer.data(), ds.tellp() );
+         }
+      }
+
       template<typename T>
       bool is_subscribed_to_item( const T& i )const
       {
@@ -385,9 +415,9 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       boost::signals2::scoped_connection _change_connection;
       boost::signals2::scoped_connection _removed_connection;
       boost::signals2::scoped_connection _applied_block_connection;
-      boost::signals2::scoped_connection _pending_trx_connection;
       map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> > _market_subscriptions;
       graphene::chain::database& _db;
+      std::shared_ptr<notification_fanout> _fanout;
       database_access_layer _dal;
 
    private:
@@ -395,6 +425,111 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void func_re_pack(IterStart helper_itr, IterEnd end, std::vector<agregated_limit_orders_with_same_price_collection>& ret, uint32_t limit_group, uint32_t limit_per_group) const;
 };
 
+/**
+ *  Pending transaction and applied block notifications are the same for every API session of a database.  Rather
+ *  than have each database_api_impl convert the event to a variant on its own, one notification_fanout per database
+ *  hands the event to its own "api notifications" thread, which builds the payload once and passes the same
+ *  immutable copy to every session with a callback set.  The chain thread only copies the event and the callbacks.
+ */
+class notification_fanout
+{
+   public:
+      typedef std::vector< std::weak_ptr<database_api_impl> > subscriber_list;
+
+      explicit notification_fanout( graphene::chain::database& db )
+         : _thread( "api notifications" )
+      {
+         _pending_trx_connection = db.on_pending_transaction.connect( [this]( const signed_transaction& trx ) {
+            if( !pending_trx_subscribers.empty() )
+               deliver( pending_trx_subscribers, &database_api_impl::_pending_trx_callback, trx );
+         });
+         _applied_block_connection = db.applied_block.connect( [this]( const signed_block& b ) {
+            if( !block_applied_subscribers.empty() )
+               deliver( block_applied_subscribers, &database_api_impl::_block_applied_callback, b.id() );
+         });
+      }
+
+      /** @return the fan-out of the database, created when the first API session of the database asks for it */
+      static std::shared_ptr<notification_fanout> get( graphene::chain::database& db )
+      {
+         static std::map< const graphene::chain::database*, std::weak_ptr<notification_fanout> > instances;
+         for( auto itr = instances.begin(); itr != instances.end(); )
+         {
+            if( itr->second.expired() && itr->first != &db )
+               itr = instances.erase( itr );
+            else
+               ++itr;
+         }
+
+         auto& instance = instances[&db];
+         auto result = instance.lock();
+         if( !result )
+         {
+            result = std::make_shared<notification_fanout>( db );
+            instance = result;
+         }
+         return result;
+      }
+
+      void subscribe( subscriber_list& subscribers, const std::shared_ptr<database_api_impl>& api )
+      {
+         for( const auto& s : subscribers )
+            if( s.lock() == api )
+               return;
+         subscribers.emplace_back( api );
+      }
+
+      subscriber_list pending_trx_subscribers;
+      subscriber_list block_applied_subscribers;
+
+   private:
+      typedef std::function<void(const fc::variant&)> callback_type;
+      typedef callback_type database_api_impl::* callback_member;
+
+      /**
+       *  Copy the callbacks of the live subscribers, drop the sessions which have gone away and queue the event on
+       *  the notification thread.  The callbacks are copied here because sessions replace them on the chain thread.
+       */
+      template<typename Event>
+      void deliver( subscriber_list& subscribers, callback_member callback, const Event& event )
+      {
+         auto receivers = std::make_shared< std::vector<callback_type> >();
+         receivers->reserve( subscribers.size() );
+         auto keep = subscribers.begin();
+         for( auto itr = subscribers.begin(); itr != subscribers.end(); ++itr )
+         {
+            auto api = itr->lock();
+            if( !api )
+               continue;
+            if( (*api).*callback )
+               receivers->push_back( (*api).*callback );
+            *keep++ = *itr;
+         }
+         subscribers.erase( keep, subscribers.end() );
+         if( receivers->empty() )
+            return;
+
+         _thread.async( [receivers, event]() {
+            const fc::variant payload( event );
+            for( const auto& cb : *receivers )
+            {
+               try
+               {
+                  cb( payload );
+               }
+               catch( const fc::exception& e )
+               {
+                  wlog( "API notification failed: ${e}", ("e", e.to_detail_string()) );
+               }
+            }
+         });
+      }
+
+      fc::thread _thread;
+      boost::signals2::scoped_connection _pending_trx_connection;
+      boost::signals2::scoped_connection _applied_block_connection;
+};
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Constructors                                                     //
@@ -419,10 +554,7 @@ database_api_impl::database_api_impl( graphene::chain::database& db ): _db(db),
                                                      on_objects_removed(ids, objs, impacted_accounts);
                                                    });
    _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
-
-   _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction& trx ){
-                         if( _pending_trx_callback ) _pending_trx_callback( fc::variant(trx) );
-                      });
+   _fanout = notification_fanout::get( _db );
 }
 
 database_api_impl::~database_api_impl()
@@ -444,28 +576,21 @@ fc::variants database_api::get_objects(const vector<object_id_type>& ids)const
 fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)const
 {
    if( _subscribe_callback )  {
-      for( auto id : ids )
-      {
-         if( id.type() == operation_history_object_type && id.space() == protocol_ids ) continue;
-         if( id.type() == impl_account_transaction_history_object_type && id.space() == implementation_ids ) continue;
-
-         this->subscribe_to_item( id );
-      }
+      subscribe_to_objects( ids );
    }
    else
    {
       elog( "getObjects without subscribe callback??" );
    }
 
-   fc::variants result;
-   result.reserve(ids.size());
+   // Only the lookup is batched; each object is still converted to a variant on its own
+   vector<const object*> objects;
+   _db.find_objects( ids, objects );
 
-   std::transform(ids.begin(), ids.end(), std::back_inserter(result),
-                  [this](object_id_type id) -> fc::variant {
-      if(auto obj = _db.find_object(id))
-         return obj->to_variant();
-      return {};
-   });
+   fc::variants result( ids.size() );
+   for( size_t i = 0; i < objects.size(); ++i )
+      if( objects[i] != nullptr )
+         result[i] = objects[i]->to_variant();
 
    return result;
 }
@@ -503,6 +628,8 @@ void database_api::set_pending_transaction_callback( std::function<void(const va
 void database_api_impl::set_pending_transaction_callback( std::function<void(const variant&)> cb )
 {
    _pending_trx_callback = cb;
+   if( _pending_trx_callback )
+      _fanout->subscribe( _fanout->pending_trx_subscribers, shared_from_this() );
 }
 
 void database_api::set_block_applied_callback( std::function<void(const variant& block_id)> cb )
@@ -513,6 +640,8 @@ void database_api::set_block_applied_callback( std::function<void(const variant&
 void database_api_impl::set_block_applied_callback( std::function<void(const variant& block_id)> cb )
 {
    _block_applied_callback = cb;
+   if( _block_applied_callback )
+      _fanout->subscribe( _fanout->block_applied_subscribers, shared_from_this() );
 }
 
 void database_api::cancel_all_subscriptions()
@@ -654,7 +783,31 @@ dynamic_global_property_object database_api::get_dynamic_global_properties()cons
 
 dynamic_global_property_object database_api_impl::get_dynamic_global_properties()const
 {
-   return _db.get(dynamic_global_property_id_type());
+   dynamic_global_property_object result = _db.get(dynamic_global_property_id_type());
+   // Trade prices are no longer written to this object, report the current ones:
+   result.last_dascoin_price = _db.get_last_dascoin_price();
+   result.last_btc_price = _db.get_last_btc_price();
+   return result;
+}
+
+undo_stats database_api::get_undo_history_stats()const
+{
+   return my->get_undo_history_stats();
+}
+
+undo_stats database_api_impl::get_undo_history_stats()const
+{
+   return _db._undo_db.get_stats();
+}
+
+block_production_stats database_api::get_block_production_stats()const
+{
+   return my->get_block_production_stats();
+}
+
+block_production_stats database_api_impl::get_block_production_stats()const
+{
+   return _db.get_block_production_stats();
 }
 
 optional<total_cycles_res> database_api::get_total_cycles() const {
@@ -947,6 +1100,31 @@ map<string,account_id_type> database_api_impl::lookup_accounts(const string& low
    return result;
 }
 
+vector<pair<string,account_id_type>> database_api::search_accounts(const string& query, account_id_type start, uint32_t limit)const
+{
+   return my->search_accounts( query, start, limit );
+}
+
+vector<pair<string,account_id_type>> database_api_impl::search_accounts(const string& query, account_id_type start, uint32_t limit)const
+{
+   FC_ASSERT( limit <= 1000 );
+   FC_ASSERT( query.size() >= account_name_search_index::min_query_length,
+              "Search query must be at least ${n} characters long", ("n", account_name_search_index::min_query_length) );
+   const auto search_index = _db.get_account_name_search();
+   FC_ASSERT( search_index != nullptr, "Account name search is not enabled on this node" );
+
+   string lower_query = query;
+   std::transform( lower_query.begin(), lower_query.end(), lower_query.begin(),
+                   []( unsigned char c ) { return char( std::tolower( c ) ); } );
+
+   vector<pair<string,account_id_type>> result;
+   const auto account_ids = search_index->search( lower_query, start, limit );
+   result.reserve( account_ids.size() );
+   for( const auto& id : account_ids )
+      result.emplace_back( id(_db).name, id );
+   return result;
+}
+
 uint64_t database_api::get_account_count()const
 {
    return my->get_account_count();
@@ -1756,6 +1934,28 @@ bool database_api_impl::check_issued_webeur(const string& unique_id) const
     return _dal.check_issued_webeur(unique_id);
 }
 
+vector<string> database_api::check_issued_assets(const vector<string>& unique_ids, const string& asset) const
+{
+    return my->check_issued_assets(unique_ids, asset);
+}
+
+vector<string> database_api_impl::check_issued_assets(const vector<string>& unique_ids, const string& asset) const
+{
+    FC_ASSERT( unique_ids.size() <= 10000 );
+    return _dal.check_issued_assets(unique_ids, asset);
+}
+
+vector<string> database_api::check_issued_webeurs(const vector<string>& unique_ids) const
+{
+    return my->check_issued_webeurs(unique_ids);
+}
+
+vector<string> database_api_impl::check_issued_webeurs(const vector<string>& unique_ids) const
+{
+    FC_ASSERT( unique_ids.size() <= 10000 );
+    return _dal.check_issued_webeurs(unique_ids);
+}
+
 order_book database_api::get_order_book( const string& base, const string& quote, unsigned limit )const
 {
    return my->get_order_book( base, quote, limit);
@@ -2903,53 +3103,25 @@ vector<das33_pledge_holder_object> database_api_impl::get_das33_pledges(das33_pl
 
 das33_pledges_by_account_result database_api_impl::get_das33_pledges_by_account(account_id_type account) const
 {
-    vector<das33_pledge_holder_object> pledges;
-    map<das33_project_id_type, share_type> total;
-    map<das33_project_id_type, share_type> last_round;
+    das33_pledges_by_account_result result;
 
-    const auto& idx = _db.get_index_type<das33_pledge_holder_index>().indices().get<by_user>().equal_range(account);
-    std::copy(idx.first, idx.second, std::back_inserter(pledges));
+    const auto& idx = _db.get_index_type<das33_pledge_holder_index>();
+    const auto& range = idx.indices().get<by_user>().equal_range(account);
+    std::copy(range.first, range.second, std::back_inserter(result.pledges));
 
-    map<das33_project_id_type, share_type> last_round_number;
-    for (u_int i = 0; i < pledges.size(); i++)
+    const auto& totals = dynamic_cast<const primary_index<das33_pledge_holder_index>&>(idx).get_secondary_index<das33_pledge_totals_index>();
+    const auto* rounds = totals.find_user_rounds(account);
+    if (rounds == nullptr)
+      return result;
+
+    // Rounds are ordered by project and phase, so the last one seen for a project is its latest round
+    for (const auto& round : *rounds)
     {
-      das33_project_id_type project_id = pledges[i].project_id;
-      share_type round_number = pledges[i].phase_number;
-      if (total.find(project_id) != total.end())
-      {
-         total[project_id] = total[project_id] + pledges[i].base_expected.amount + pledges[i].bonus_expected.amount;
-      }
-      else
-      {
-        total[project_id] = pledges[i].base_expected.amount + pledges[i].bonus_expected.amount;
-      }
-      if (last_round_number.find(project_id) != last_round_number.end())
-      {
-        if (last_round_number[project_id] < round_number)
-          last_round_number[project_id] = round_number;
-      }
-      else
-      {
-          last_round_number[project_id] = round_number;
-      }
-    }
-    for (u_int j = 0; j < pledges.size(); j++)
-    {
-      das33_project_id_type project_id = pledges[j].project_id;
-      share_type round_number = pledges[j].phase_number;
-      if (round_number == last_round_number[project_id])
-      {
-        if (last_round.find(project_id) != last_round.end())
-          last_round[project_id] = last_round[project_id] + pledges[j].base_expected.amount;
-        else
-          last_round[project_id] = pledges[j].base_expected.amount;
-      }
+      const das33_project_id_type project_id = round.first.first;
+      result.total_expected[project_id] += round.second.base_expected + round.second.bonus_expected;
+      result.base_expected_in_last_round[project_id] = round.second.base_expected;
     }
 
-    das33_pledges_by_account_result result;
-    result.pledges = pledges;
-    result.total_expected = total;
-    result.base_expected_in_last_round = last_round;
     return result;
 }
 
@@ -3004,25 +3176,15 @@ vector<asset> database_api::get_amount_of_assets_pledged_to_project(das33_projec
 vector<asset> database_api_impl::get_amount_of_assets_pledged_to_project(das33_project_id_type project) const
 {
   vector<asset> result;
-  map<asset_id_type, int> index_map;
 
-  auto default_pledge_id = das33_pledge_holder_id_type();
-
-  const auto& pledges = _db.get_index_type<das33_pledge_holder_index>().indices().get<by_project>();
-  for( auto itr = pledges.lower_bound(project); itr != pledges.upper_bound(project); ++itr )
+  const auto& idx = _db.get_index_type<das33_pledge_holder_index>();
+  const auto& totals = dynamic_cast<const primary_index<das33_pledge_holder_index>&>(idx).get_secondary_index<das33_pledge_totals_index>();
+  const auto* assets = totals.find_project_assets(project);
+  if (assets != nullptr)
   {
-   if (itr->id != default_pledge_id)
-   {
-     if (index_map.find(itr->pledged.asset_id) != index_map.end())
-     {
-       result[index_map[itr->pledged.asset_id]] += itr->pledged;
-     }
-     else
-     {
-       index_map[itr->pledged.asset_id] = result.size();
-       result.emplace_back(itr->pledged);
-     }
-   }
+    result.reserve(assets->size());
+    for (const auto& a : *assets)
+      result.emplace_back(a.second.pledged, a.first);
   }
 
   return result;
@@ -3093,6 +3255,7 @@ vector<last_price_object> database_api_impl::get_last_prices() const
 {
   vector<last_price_object> result;
   const auto& idx = _db.get_index_type<last_price_index>().indices().get<by_market_key>();
+  result.reserve(idx.size());
   for (auto itr = idx.begin(); itr != idx.end(); itr++)
     result.emplace_back(*itr);
   return result;
@@ -3107,6 +3270,7 @@ vector<external_price_object> database_api_impl::get_external_prices() const
 {
   vector<external_price_object> result;
   const auto& idx = _db.get_index_type<external_price_index>().indices().get<by_market_key>();
+  result.reserve(idx.size());
   for (auto itr = idx.begin(); itr != idx.end(); itr++)
     result.emplace_back(*itr);
   return result;
@@ -3224,15 +3388,7 @@ void database_api_impl::handle_object_changed(bool force_notify, bool full_objec
  */
 void database_api_impl::on_applied_block()
 {
-   if (_block_applied_callback)
-   {
-      auto capture_this = shared_from_this();
-      block_id_type block_id = _db.head_block_id();
-      fc::async([this,capture_this,block_id](){
-         _block_applied_callback(fc::variant(block_id));
-      });
-   }
-
+   // _block_applied_callback is called by notification_fanout
    if(_market_subscriptions.size() == 0)
       return;
 
@@ -3261,7 +3417,7 @@ void database_api_impl::on_applied_block()
          default: break;
       }
       if(_market_subscriptions.count(market))
-         subscribed_markets_ops[market].push_back(std::make_pair(op.op, op.result));
+         subscribed_markets_ops[market].push_back(std::make_pair(op.op.to_operation(), op.result));
    }
    /// we need to ensure the database_api is not deleted for the life of the async operation
    auto capture_this = shared_from_this();
@@ -28,6 +28,7 @@
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/chain/protocol/confidential.hpp>
 
+#include <graphene/account_history/account_history_plugin.hpp>
 #include <graphene/market_history/market_history_plugin.hpp>
 
 #include <graphene/debug_witness/debug_api.hpp>
@@ -124,6 +125,12 @@ namespace graphene { namespace app {
                                                                         unsigned limit = 100,
                                                                         uint32_t start = 0) const;
 
+         /**
+          * @brief Get the number of the last block whose operations are included in account history
+          * @return The head block number, or the block history indexing has reached when it runs asynchronously
+          */
+         uint32_t get_account_history_block_num()const;
+
          vector<order_history_object> get_fill_order_history( asset_id_type a, asset_id_type b, uint32_t limit )const;
          vector<bucket_object> get_market_history( asset_id_type a, asset_id_type b, uint32_t bucket_seconds,
                                                    fc::time_point_sec start, fc::time_point_sec end )const;
@@ -136,6 +143,8 @@ namespace graphene { namespace app {
                                                                    unsigned limit = 100,
                                                                    operation_history_id_type start = operation_history_id_type())const;
 
+         const graphene::account_history::sharded_history_store* async_history()const;
+
       private:
          application& _app;
    };
@@ -336,6 +345,7 @@ FC_API(graphene::app::history_api,
        (get_account_history)
        (get_account_history_by_operation)
        (get_relative_account_history)
+       (get_account_history_block_num)
        (get_fill_order_history)
        (get_market_history)
        (get_market_history_buckets)
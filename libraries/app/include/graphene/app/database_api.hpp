@@ -214,6 +214,10 @@ class database_api
        * @return The objects retrieved, in the order they are mentioned in ids
        *
        * If any of the provided IDs does not map to an object, a null variant is returned in its position.
+       *
+       * The last_dascoin_price and last_btc_price fields of the dynamic global properties (2.1.0), here and in
+       * object notifications, hold the genesis prices only; trades are recorded in the last_price_object of
+       * their market.  Use @ref get_dynamic_global_properties or @ref get_last_prices for the current prices.
        */
       fc::variants get_objects(const vector<object_id_type>& ids)const;
 
@@ -305,9 +309,22 @@ class database_api
 
       /**
        * @brief Retrieve the current @ref dynamic_global_property_object
+       *
+       * last_dascoin_price and last_btc_price are filled in from the DSC:WEBEUR and BTC:WEBEUR last_price_objects.
        */
       dynamic_global_property_object get_dynamic_global_properties() const;
 
+      /**
+       * @brief Get the depth and estimated memory usage of this node's undo history
+       */
+      undo_stats get_undo_history_stats() const;
+
+      /**
+       * @brief Get the blocks this node generated, how many transactions it deferred to keep within its
+       * block production time budget and how long after the start of their slots the blocks were broadcast
+       */
+      block_production_stats get_block_production_stats() const;
+
       /**
        * @brief Get the total amount of cycles and total potential amount of dascoin
        */
@@ -369,6 +386,17 @@ class database_api
        */
       map<string,account_id_type> lookup_accounts(const string& lower_bound_name, uint32_t limit)const;
 
+      /**
+       * @brief Find registered accounts whose name contains a string
+       * @param query Part of the account name to search for, matched case insensitively; at least 3 characters
+       * @param start First account ID to consider; to fetch the next page pass the ID after the last one returned
+       * @param limit Maximum number of results to return -- must not exceed 1000
+       * @return Names and IDs of the matching accounts, ordered by account ID
+       *
+       * Only available on nodes started with enable-account-name-search.
+       */
+      vector<pair<string,account_id_type>> search_accounts(const string& query, account_id_type start, uint32_t limit)const;
+
       //////////////
       // Balances //
       //////////////
@@ -588,6 +616,21 @@ class database_api
        **/
       bool check_issued_webeur(const string& unique_id) const;
 
+      /**
+       * @brief Check which of the given asset issues were completed on the chain.
+       * @param unique_ids The unique indentifier strings of the issues, at most 10000
+       * @param asset The name or id of the asset.
+       * @return The unique ids of the completed issues, in the order given.
+       **/
+      vector<string> check_issued_assets(const vector<string>& unique_ids, const string& asset) const;
+
+      /**
+       * @brief Check which of the given webeur issues were completed on the chain.
+       * @param unique_ids The unique indentifier strings of the issues, at most 10000
+       * @return The unique ids of the completed issues, in the order given.
+       **/
+      vector<string> check_issued_webeurs(const vector<string>& unique_ids) const;
+
       ///////////////
       // Witnesses //
       ///////////////
@@ -987,7 +1030,7 @@ class database_api
       /**
        * @brief Gets a sum of all pledges made to project
        * @params project id of a project
-       * @return vector of assets, each with total sum of that asset pledged
+       * @return vector of assets, each with total sum of that asset pledged, ordered by asset id
        */
       vector<asset> get_amount_of_assets_pledged_to_project(das33_project_id_type project) const;
 
@@ -1068,6 +1111,8 @@ FC_API( graphene::app::database_api,
    (get_config)
    (get_chain_id)
    (get_dynamic_global_properties)
+   (get_undo_history_stats)
+   (get_block_production_stats)
    (get_total_cycles)
 
    // Keys
@@ -1080,6 +1125,7 @@ FC_API( graphene::app::database_api,
    (get_account_references)
    (lookup_account_names)
    (lookup_accounts)
+   (search_accounts)
    (get_account_count)
 
    // Balances
@@ -1113,6 +1159,8 @@ FC_API( graphene::app::database_api,
    (get_trade_history_by_sequence)
    (check_issued_asset)
    (check_issued_webeur)
+   (check_issued_assets)
+   (check_issued_webeurs)
 
    // Witnesses
    (get_witnesses)
@@ -23,20 +23,12 @@
  */
 #pragma once
 
-#include <fc/container/flat.hpp>
-#include <graphene/chain/protocol/operations.hpp>
-#include <graphene/chain/protocol/transaction.hpp>
-#include <graphene/chain/protocol/types.hpp>
+#include <graphene/chain/impacted_accounts.hpp>
 
 namespace graphene { namespace app {
 
-void operation_get_impacted_accounts(
-   const graphene::chain::operation& op,
-   fc::flat_set<graphene::chain::account_id_type>& result );
-
-void transaction_get_impacted_accounts(
-   const graphene::chain::transaction& tx,
-   fc::flat_set<graphene::chain::account_id_type>& result
-   );
+// The impacted account table lives in the chain library, which also uses it for object change notifications
+using graphene::chain::operation_get_impacted_accounts;
+using graphene::chain::transaction_get_impacted_accounts;
 
 } } // graphene::app
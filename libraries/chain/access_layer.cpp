@@ -317,17 +317,26 @@ bool database_access_layer::check_issued_asset(const string& unique_id, const st
 {
     const auto res = lookup_asset_symbol(asset);
     if ( res.valid() )
-    {
-        const auto record = get_issued_asset_record(unique_id, res->id);
-        return record.valid();
-    }
+        return is_issued(unique_id, res->id);
     return false;
 }
 
 bool database_access_layer::check_issued_webeur(const string& unique_id) const
 {
-    const auto web_id = _db.get_web_asset_id();
-    return get_issued_asset_record(unique_id, web_id).valid();
+    return is_issued(unique_id, _db.get_web_asset_id());
+}
+
+vector<string> database_access_layer::check_issued_assets(const vector<string>& unique_ids, const string& asset) const
+{
+    const auto res = lookup_asset_symbol(asset);
+    if ( res.valid() )
+        return filter_issued(unique_ids, res->id);
+    return {};
+}
+
+vector<string> database_access_layer::check_issued_webeurs(const vector<string>& unique_ids) const
+{
+    return filter_issued(unique_ids, _db.get_web_asset_id());
 }
 
 optional<asset_object> database_access_layer::get_asset_symbol(const asset_index &index, const string& symbol_or_id) const
@@ -342,6 +351,22 @@ optional<asset_object> database_access_layer::get_asset_symbol(const asset_index
     return itr == asset_by_symbol.end() ? optional<asset_object>{} : *itr;
 }
 
+bool database_access_layer::is_issued(const string& unique_id, asset_id_type asset_id) const
+{
+    const auto& idx = _db.get_index_type<issued_asset_record_index>().indices().get<by_unique_id_asset>();
+    return idx.find(boost::make_tuple(unique_id, asset_id)) != idx.end();
+}
+
+vector<string> database_access_layer::filter_issued(const vector<string>& unique_ids, asset_id_type asset_id) const
+{
+    const auto& idx = _db.get_index_type<issued_asset_record_index>().indices().get<by_unique_id_asset>();
+    vector<string> result;
+    std::copy_if(unique_ids.begin(), unique_ids.end(), std::back_inserter(result), [&](const string& unique_id) {
+        return idx.find(boost::tuple<const string&, asset_id_type>(unique_id, asset_id)) != idx.end();
+    });
+    return result;
+}
+
 // TODO:
 optional<issued_asset_record_object>
 database_access_layer::get_issued_asset_record(const string& unique_id, asset_id_type asset_id) const
@@ -110,33 +110,35 @@ void account_statistics_object::pay_fee( share_type core_fee, share_type cashbac
       pending_vested_fees += core_fee;
 }
 
-set<account_id_type> account_member_index::get_account_members(const account_object& a)const
+set<account_id_type> account_member_index::get_account_members( const authority& owner, const authority& active )const
 {
    set<account_id_type> result;
-   for( auto auth : a.owner.account_auths )
+   for( auto auth : owner.account_auths )
       result.insert(auth.first);
-   for( auto auth : a.active.account_auths )
+   for( auto auth : active.account_auths )
       result.insert(auth.first);
    return result;
 }
-set<public_key_type> account_member_index::get_key_members(const account_object& a)const
+set<public_key_type> account_member_index::get_key_members( const authority& owner, const authority& active,
+                                                            const public_key_type& memo_key )const
 {
    set<public_key_type> result;
-   for( auto auth : a.owner.key_auths )
+   for( auto auth : owner.key_auths )
       result.insert(auth.first);
-   for( auto auth : a.active.key_auths )
+   for( auto auth : active.key_auths )
       result.insert(auth.first);
-   result.insert( a.options.memo_key );
+   result.insert( memo_key );
    return result;
 }
-set<address> account_member_index::get_address_members(const account_object& a)const
+set<address> account_member_index::get_address_members( const authority& owner, const authority& active,
+                                                         const public_key_type& memo_key )const
 {
    set<address> result;
-   for( auto auth : a.owner.address_auths )
+   for( auto auth : owner.address_auths )
       result.insert(auth.first);
-   for( auto auth : a.active.address_auths )
+   for( auto auth : active.address_auths )
       result.insert(auth.first);
-   result.insert( a.options.memo_key );
+   result.insert( memo_key );
    return result;
 }
 
@@ -145,15 +147,15 @@ void account_member_index::object_inserted(const object& obj)
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto account_members = get_account_members(a);
+    auto account_members = get_account_members(a.owner, a.active);
     for( auto item : account_members )
        account_to_account_memberships[item].insert(obj.id);
 
-    auto key_members = get_key_members(a);
+    auto key_members = get_key_members(a.owner, a.active, a.options.memo_key);
     for( auto item : key_members )
        account_to_key_memberships[item].insert(obj.id);
 
-    auto address_members = get_address_members(a);
+    auto address_members = get_address_members(a.owner, a.active, a.options.memo_key);
     for( auto item : address_members )
        account_to_address_memberships[item].insert(obj.id);
 }
@@ -163,37 +165,28 @@ void account_member_index::object_removed(const object& obj)
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto key_members = get_key_members(a);
+    auto key_members = get_key_members(a.owner, a.active, a.options.memo_key);
     for( auto item : key_members )
        account_to_key_memberships[item].erase( obj.id );
 
-    auto address_members = get_address_members(a);
+    auto address_members = get_address_members(a.owner, a.active, a.options.memo_key);
     for( auto item : address_members )
        account_to_address_memberships[item].erase( obj.id );
 
-    auto account_members = get_account_members(a);
+    auto account_members = get_account_members(a.owner, a.active);
     for( auto item : account_members )
        account_to_account_memberships[item].erase( obj.id );
 }
 
-void account_member_index::about_to_modify(const object& before)
-{
-   before_key_members.clear();
-   before_account_members.clear();
-   assert( dynamic_cast<const account_object*>(&before) ); // for debug only
-   const account_object& a = static_cast<const account_object&>(before);
-   before_key_members     = get_key_members(a);
-   before_address_members = get_address_members(a);
-   before_account_members = get_account_members(a);
-}
-
 void account_member_index::object_modified(const object& after)
 {
     assert( dynamic_cast<const account_object*>(&after) ); // for debug only
     const account_object& a = static_cast<const account_object&>(after);
+    const account_member_fields& before = saved_fields();
 
     {
-       set<account_id_type> after_account_members = get_account_members(a);
+       set<account_id_type> before_account_members = get_account_members(before.owner, before.active);
+       set<account_id_type> after_account_members = get_account_members(a.owner, a.active);
        vector<account_id_type> removed; removed.reserve(before_account_members.size());
        std::set_difference(before_account_members.begin(), before_account_members.end(),
                            after_account_members.begin(), after_account_members.end(),
@@ -213,7 +206,8 @@ void account_member_index::object_modified(const object& after)
 
 
     {
-       set<public_key_type> after_key_members = get_key_members(a);
+       set<public_key_type> before_key_members = get_key_members(before.owner, before.active, before.memo_key);
+       set<public_key_type> after_key_members = get_key_members(a.owner, a.active, a.options.memo_key);
 
        vector<public_key_type> removed; removed.reserve(before_key_members.size());
        std::set_difference(before_key_members.begin(), before_key_members.end(),
@@ -233,7 +227,8 @@ void account_member_index::object_modified(const object& after)
     }
 
     {
-       set<address> after_address_members = get_address_members(a);
+       set<address> before_address_members = get_address_members(before.owner, before.active, before.memo_key);
+       set<address> after_address_members = get_address_members(a.owner, a.active, a.options.memo_key);
 
        vector<address> removed; removed.reserve(before_address_members.size());
        std::set_difference(before_address_members.begin(), before_address_members.end(),
@@ -260,11 +255,109 @@ void account_referrer_index::object_inserted( const object& obj )
 void account_referrer_index::object_removed( const object& obj )
 {
 }
-void account_referrer_index::about_to_modify( const object& before )
+void account_referrer_index::object_modified( const object& after  )
 {
 }
-void account_referrer_index::object_modified( const object& after  )
+
+const size_t account_name_search_index::min_query_length;
+
+set<account_name_search_index::trigram_type> account_name_search_index::get_trigrams( const string& name )
+{
+   set<trigram_type> result;
+   for( size_t i = 0; i + 3 <= name.size(); ++i )
+      result.insert( ( trigram_type(uint8_t(name[i])) << 16 )
+                   | ( trigram_type(uint8_t(name[i+1])) << 8 )
+                   | trigram_type(uint8_t(name[i+2])) );
+   return result;
+}
+
+void account_name_search_index::add_name( account_id_type id, const string& name )
+{
+   const auto instance = id.instance.value;
+   if( instance >= _names.size() )
+      _names.resize( instance + 1 );
+   _names[instance] = name;
+
+   for( auto trigram : get_trigrams( name ) )
+   {
+      auto& accounts = _accounts_by_trigram[trigram];
+      // accounts are almost always created in id order, so this is usually an append
+      accounts.insert( std::lower_bound( accounts.begin(), accounts.end(), id ), id );
+   }
+}
+
+void account_name_search_index::remove_name( account_id_type id, const string& name )
 {
+   const auto instance = id.instance.value;
+   if( instance < _names.size() )
+      _names[instance].clear();
+
+   for( auto trigram : get_trigrams( name ) )
+   {
+      auto itr = _accounts_by_trigram.find( trigram );
+      if( itr == _accounts_by_trigram.end() )
+         continue;
+      auto& accounts = itr->second;
+      auto pos = std::lower_bound( accounts.begin(), accounts.end(), id );
+      if( pos != accounts.end() && *pos == id )
+         accounts.erase( pos );
+      if( accounts.empty() )
+         _accounts_by_trigram.erase( itr );
+   }
+}
+
+void account_name_search_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+   const account_object& a = static_cast<const account_object&>(obj);
+   add_name( a.id, a.name );
+}
+
+void account_name_search_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+   const account_object& a = static_cast<const account_object&>(obj);
+   remove_name( a.id, a.name );
+}
+
+void account_name_search_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const account_object*>(&after) ); // for debug only
+   const account_object& a = static_cast<const account_object&>(after);
+   remove_name( a.id, saved_fields().name );
+   add_name( a.id, a.name );
+}
+
+vector<account_id_type> account_name_search_index::search( const string& query, account_id_type start,
+                                                           uint32_t limit )const
+{
+   vector<account_id_type> result;
+   // Shorter queries have no trigram to narrow the candidates, answering them would mean scanning every name
+   if( limit == 0 || query.size() < min_query_length )
+      return result;
+
+   auto matches = [&]( uint64_t instance ) {
+      return instance < _names.size() && _names[instance].find( query ) != string::npos;
+   };
+
+   const auto trigrams = get_trigrams( query );
+
+   const vector<account_id_type>* shortest = nullptr;
+   for( auto trigram : trigrams )
+   {
+      auto itr = _accounts_by_trigram.find( trigram );
+      if( itr == _accounts_by_trigram.end() )
+         return result;
+      if( shortest == nullptr || itr->second.size() < shortest->size() )
+         shortest = &itr->second;
+   }
+
+   for( auto itr = std::lower_bound( shortest->begin(), shortest->end(), start );
+        itr != shortest->end() && result.size() < limit;
+        ++itr )
+      if( matches( itr->instance.value ) )
+         result.push_back( *itr );
+   return result;
 }
 
 } } // graphene::chain
@@ -701,6 +701,8 @@ void_result update_external_btc_price_evaluator::do_evaluate(const update_extern
 void_result update_external_btc_price_evaluator::do_apply(const update_external_btc_price_operation& o)
 { try {
 
+  // Kept on the dynamic global properties: the BTC:WEBEUR external_price_object can also be written by
+  // update_external_token_price_operation and must not change the price das33 pledges use.
   auto btc_price = o.eur_amount_per_btc;
   db().modify(db().get_dynamic_global_properties(), [btc_price](dynamic_global_property_object& dgpo){
     dgpo.external_btc_price = btc_price;
@@ -721,26 +723,8 @@ void_result update_external_token_price_evaluator::do_evaluate(const update_exte
 
 void_result update_external_token_price_evaluator::do_apply(const update_external_token_price_operation& o)
 { try {
-  price token_price = o.eur_amount_per_token;
-  time_point_sec timestamp = db().head_block_time();
-
-  const auto& idx = db().get_index_type<external_price_index>().indices().get<by_market_key>();
-  auto itr = idx.find(market_key{o.token_id, db().get_web_asset_id()});
-  if (itr != idx.end())
-  {
-    db().modify(*itr, [token_price, timestamp] (external_price_object &lpo) {
-      lpo.external_price = token_price;
-      lpo.timestamp = timestamp;
-    });
-  }
-  else
-  {
-    db().create<external_price_object>([&](external_price_object &lpo) {
-      lpo.market = market_key{o.token_id, db().get_web_asset_id()};
-      lpo.external_price = token_price;
-      lpo.timestamp = timestamp;
-    });
-  }
+  auto& d = db();
+  d.set_external_price(market_key{o.token_id, d.get_web_asset_id()}, o.eur_amount_per_token);
 
   return {};
 
@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/confidential_proof_verifier.hpp>
+#include <graphene/chain/config.hpp>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+struct proofs_visitor
+{
+   typedef bool result_type;
+
+   /// when false, only report whether the operation has proofs
+   bool verify;
+
+   template<typename T>
+   bool operator()( const T& )const { return false; }
+
+   bool operator()( const transfer_to_blind_operation& op )const { return check( op ); }
+   bool operator()( const transfer_from_blind_operation& op )const { return check( op ); }
+   bool operator()( const blind_transfer_operation& op )const { return check( op ); }
+
+   template<typename T>
+   bool check( const T& op )const
+   {
+      if( verify )
+         op.validate_proofs();
+      return true;
+   }
+};
+
+struct structure_visitor
+{
+   typedef void result_type;
+
+   template<typename T>
+   void operator()( const T& op )const { op.validate(); }
+
+   void operator()( const transfer_to_blind_operation& op )const { op.validate_structure(); }
+   void operator()( const transfer_from_blind_operation& op )const { op.validate_structure(); }
+   void operator()( const blind_transfer_operation& op )const { op.validate_structure(); }
+};
+
+}
+
+confidential_proof_verifier::confidential_proof_verifier() {}
+
+confidential_proof_verifier::~confidential_proof_verifier()
+{
+   for( auto& t : _threads )
+      t->quit();
+}
+
+bool confidential_proof_verifier::has_proofs( const transaction& trx )
+{
+   const proofs_visitor visitor{ false };
+   for( const auto& op : trx.operations )
+      if( op.visit( visitor ) )
+         return true;
+   return false;
+}
+
+void confidential_proof_verifier::validate_without_proofs( const transaction& trx )
+{
+   FC_ASSERT( trx.operations.size() > 0, "A transaction must have at least one operation", ("trx",trx) );
+   for( const auto& op : trx.operations )
+      op.visit( structure_visitor() );
+}
+
+void confidential_proof_verifier::verify_proofs( const transaction& trx )
+{
+   const proofs_visitor visitor{ true };
+   for( const auto& op : trx.operations )
+      op.visit( visitor );
+}
+
+void confidential_proof_verifier::precompute( const signed_block& block )
+{
+   for( const auto& trx : block.transactions )
+   {
+      if( !has_proofs( trx ) )
+         continue;
+      const digest_type digest = trx.digest();
+      if( _results.find( digest ) != _results.end() )
+         continue;
+
+      if( _threads.empty() )
+         for( uint32_t i = 0; i < GRAPHENE_CONFIDENTIAL_PROOF_THREADS; ++i )
+            _threads.emplace_back( new fc::thread( "confidential_proofs" ) );
+
+      // The block may be gone before the worker gets to it:
+      auto copy = std::make_shared<transaction>( trx );
+      fc::thread& worker = *_threads[_next_thread++ % _threads.size()];
+      remember( digest, worker.async( [copy]() { verify_proofs( *copy ); }, "verify_confidential_proofs" ) );
+   }
+}
+
+void confidential_proof_verifier::verify( const transaction& trx )
+{
+   const digest_type digest = trx.digest();
+   auto itr = _results.find( digest );
+   if( itr != _results.end() )
+   {
+      // Rethrows the failure of the verification
+      fc::future<void> result = itr->second;
+      result.wait();
+      return;
+   }
+
+   fc::promise<void>::ptr result( new fc::promise<void>( "verify_confidential_proofs" ) );
+   try
+   {
+      verify_proofs( trx );
+      result->set_value();
+   }
+   catch( const fc::exception& e )
+   {
+      result->set_exception( e.dynamic_copy_exception() );
+      remember( digest, fc::future<void>( result ) );
+      throw;
+   }
+   remember( digest, fc::future<void>( result ) );
+}
+
+void confidential_proof_verifier::remember( const digest_type& digest, const fc::future<void>& result )
+{
+   if( !_results.emplace( digest, result ).second )
+      return;
+   _results_order.push_back( digest );
+   while( _results_order.size() > GRAPHENE_CONFIDENTIAL_PROOF_CACHE_SIZE )
+   {
+      // Results still being computed are waited for by whoever holds a copy of the future
+      _results.erase( _results_order.front() );
+      _results_order.pop_front();
+   }
+}
+
+} } // graphene::chain
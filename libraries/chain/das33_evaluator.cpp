@@ -30,16 +30,15 @@
 namespace graphene { namespace chain {
 
   // Helper methods:
+  const das33_pledge_totals_index& get_pledge_totals(const database& d)
+  {
+    const auto& idx = d.get_index_type<das33_pledge_holder_index>();
+    return dynamic_cast<const primary_index<das33_pledge_holder_index>&>(idx).get_secondary_index<das33_pledge_totals_index>();
+  }
+
   share_type users_total_pledges_in_round(account_id_type user_id, das33_project_id_type project_id, share_type round, const database& d)
   {
-    share_type sum = 0;
-    const auto& idx = d.get_index_type<das33_pledge_holder_index>().indices().get<by_user>().equal_range(user_id);
-    for( auto it = idx.first; it != idx.second; ++it )
-    {
-      if (it->project_id == project_id && it->phase_number == round)
-        sum += (it->base_expected.amount);
-    }
-    return sum;
+    return get_pledge_totals(d).base_expected_in_round(user_id, project_id, round);
   }
 
   void price_check(const price& price_to_check, asset_id_type first_asset, asset_id_type second_asset)
@@ -55,38 +54,36 @@ namespace graphene { namespace chain {
     price result;
     if (original_asset_id == d.get_dascoin_asset_id())
     {
-      result = d.get_dynamic_global_properties().last_dascoin_price;
+      result = d.get_last_dascoin_price();
     }
     else if (original_asset_id == d.get_btc_asset_id())
     {
       if (d.get_global_properties().das33_parameters.use_external_btc_price)
       {
-        result = d.get_dynamic_global_properties().external_btc_price;
+        result = d.get_external_btc_price();
       }
       else
       {
-        result = d.get_dynamic_global_properties().last_btc_price;
+        result = d.get_last_btc_price();
       }
     }
     else
     {
-      vector<asset_id_type> use_market_price_for_token = d.get_global_properties().das33_parameters.use_market_price_for_token;
+      const auto& use_market_price_for_token = d.get_global_properties().das33_parameters.use_market_price_for_token;
       if (std::find(use_market_price_for_token.begin(), use_market_price_for_token.end(), original_asset_id) != use_market_price_for_token.end())
       {
-        const auto& market_idx = d.get_index_type<last_price_index>().indices().get<by_market_key>();
-        auto market_itr = market_idx.find(market_key{base:original_asset_id, quote:d.get_web_asset_id()});
-        if (market_itr != market_idx.end())
+        const auto* lpo = d.find_last_price(original_asset_id, d.get_web_asset_id());
+        if (lpo != nullptr)
         {
-          result = market_itr->last_price;
+          result = lpo->last_price;
         }
       }
       else
       {
-        const auto& external_idx = d.get_index_type<external_price_index>().indices().get<by_market_key>();
-        auto external_itr = external_idx.find(market_key{base:original_asset_id, quote:d.get_web_asset_id()});
-        if (external_itr != external_idx.end())
+        const auto* epo = d.find_external_price(original_asset_id, d.get_web_asset_id());
+        if (epo != nullptr)
         {
-          result = external_itr->external_price;
+          result = epo->external_price;
         }
       }
     }
@@ -96,6 +93,40 @@ namespace graphene { namespace chain {
     return result;
   }
 
+  void das33_pledge_precheck(const das33_pledge_asset_operation& op, const database& d)
+  {
+    const auto& project_obj = op.project_id(d);
+    FC_ASSERT( op.pledged.asset_id != project_obj.token_id, "Cannot pledge project tokens" );
+    FC_ASSERT( project_obj.status == das33_project_status::active, "Pladge can only be made to active project" );
+    FC_ASSERT( project_obj.discounts.find(op.pledged.asset_id) != project_obj.discounts.end(),
+               "This asset can not be used in this project phase" );
+
+    if (project_obj.phase_end != time_point_sec::min())
+    {
+      FC_ASSERT(d.head_block_time() < project_obj.phase_end, "Can not pledge: new ICO phase hasn;t started yet");
+    }
+
+    const auto& token_obj = project_obj.token_id(d);
+    FC_ASSERT( project_obj.tokens_sold < token_obj.options.max_supply, "All tokens for project are sold" );
+    FC_ASSERT( project_obj.tokens_sold < project_obj.phase_limit, "All tokens in this phase are sold" );
+
+    // The evaluator requires at least min_pledge tokens on top of what the user already pledged in this phase:
+    const auto previous_pledges = users_total_pledges_in_round(op.account_id, op.project_id, project_obj.phase_number, d);
+    const share_type smallest_pledge = std::max(project_obj.min_pledge, share_type(0));
+    FC_ASSERT( previous_pledges + smallest_pledge <= project_obj.max_pledge,
+               "Can not buy more then ${max} tokens per phase and you already pledged for ${previous} in this phase.",
+               ("max", project_obj.max_pledge)
+               ("previous", previous_pledges));
+
+    const auto& balance_obj = d.get_balance_object(op.account_id, op.pledged.asset_id);
+    FC_ASSERT( balance_obj.get_balance() >= op.pledged,
+               "Not enough balance on user account ${a}, left ${l}, needed ${n}",
+               ("a", op.account_id)
+               ("l", d.to_pretty_string(balance_obj.get_balance()))
+               ("n", d.to_pretty_string(op.pledged))
+    );
+  }
+
   share_type precision_modifier(asset_object a, asset_object b)
   {
     share_type result = 1;
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/chain/das33_object.hpp>
+
+namespace graphene { namespace chain {
+
+void das33_pledge_totals_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const das33_pledge_holder_object*>(&obj) );
+   const auto& p = static_cast<const das33_pledge_holder_object&>(obj);
+   if( p.id == das33_pledge_holder_id_type() )
+      return;
+
+   auto& round = _user_rounds[p.account_id][std::make_pair(p.project_id, p.phase_number)];
+   round.base_expected += p.base_expected.amount;
+   round.bonus_expected += p.bonus_expected.amount;
+   ++round.pledge_count;
+
+   auto& pledged = _project_assets[p.project_id][p.pledged.asset_id];
+   pledged.pledged += p.pledged.amount;
+   ++pledged.pledge_count;
+}
+
+void das33_pledge_totals_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const das33_pledge_holder_object*>(&obj) );
+   const auto& p = static_cast<const das33_pledge_holder_object&>(obj);
+   if( p.id == das33_pledge_holder_id_type() )
+      return;
+
+   auto user_itr = _user_rounds.find( p.account_id );
+   assert( user_itr != _user_rounds.end() );
+   auto round_itr = user_itr->second.find( std::make_pair(p.project_id, p.phase_number) );
+   assert( round_itr != user_itr->second.end() );
+   if( --round_itr->second.pledge_count == 0 )
+   {
+      user_itr->second.erase( round_itr );
+      if( user_itr->second.empty() )
+         _user_rounds.erase( user_itr );
+   }
+   else
+   {
+      round_itr->second.base_expected -= p.base_expected.amount;
+      round_itr->second.bonus_expected -= p.bonus_expected.amount;
+   }
+
+   auto project_itr = _project_assets.find( p.project_id );
+   assert( project_itr != _project_assets.end() );
+   auto asset_itr = project_itr->second.find( p.pledged.asset_id );
+   assert( asset_itr != project_itr->second.end() );
+   if( --asset_itr->second.pledge_count == 0 )
+   {
+      project_itr->second.erase( asset_itr );
+      if( project_itr->second.empty() )
+         _project_assets.erase( project_itr );
+   }
+   else
+      asset_itr->second.pledged -= p.pledged.amount;
+}
+
+share_type das33_pledge_totals_index::base_expected_in_round( account_id_type user,
+                                                               das33_project_id_type project,
+                                                               share_type phase )const
+{
+   auto user_itr = _user_rounds.find( user );
+   if( user_itr == _user_rounds.end() )
+      return 0;
+   auto round_itr = user_itr->second.find( std::make_pair(project, phase) );
+   if( round_itr == user_itr->second.end() )
+      return 0;
+   return round_itr->second.base_expected;
+}
+
+const das33_pledge_totals_index::user_rounds_type* das33_pledge_totals_index::find_user_rounds( account_id_type user )const
+{
+   auto itr = _user_rounds.find( user );
+   return itr != _user_rounds.end() ? &itr->second : nullptr;
+}
+
+const map<asset_id_type, das33_pledge_totals_index::asset_totals>*
+das33_pledge_totals_index::find_project_assets( das33_project_id_type project )const
+{
+   auto itr = _project_assets.find( project );
+   return itr != _project_assets.end() ? &itr->second : nullptr;
+}
+
+} } // graphene::chain
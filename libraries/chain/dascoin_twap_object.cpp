@@ -0,0 +1,53 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/dascoin_twap_object.hpp>
+#include <graphene/chain/config.hpp>
+
+#include <fc/uint128.hpp>
+
+namespace graphene { namespace chain {
+
+uint64_t dascoin_twap_object::average() const
+{
+  if ( window_seconds == 0 )
+    return last_price;
+  return window_weighted_sum / window_seconds;
+}
+
+uint64_t dascoin_twap_object::to_twap_price(const asset& dascoin_amount, const asset& web_amount)
+{
+  if ( dascoin_amount.amount <= 0 || web_amount.amount <= 0 )
+    return 0;
+  const fc::uint128_t result = fc::uint128_t(dascoin_amount.amount.value) * DASCOIN_FIAT_ASSET_PRECISION
+                               / web_amount.amount.value;
+  return result > DASCOIN_TWAP_MAX_PRICE ? DASCOIN_TWAP_MAX_PRICE : result.to_uint64();
+}
+
+price dascoin_twap_object::from_twap_price(uint64_t twap_price, asset_id_type dascoin_id, asset_id_type web_id)
+{
+  return asset{static_cast<int64_t>(twap_price), dascoin_id} / asset{static_cast<int64_t>(DASCOIN_FIAT_ASSET_PRECISION), web_id};
+}
+
+} } // namespace graphene::chain
@@ -299,7 +299,7 @@ namespace graphene { namespace chain {
       _to_debit = asset{ tmp.amount * DASCOIN_DEFAULT_ASSET_PRECISION / *(buy_prices.begin()), d.get_dascoin_asset_id() };
     }
     else
-      _to_debit = tmp * dgpo.last_dascoin_price;
+      _to_debit = tmp * d.get_last_dascoin_price();
 
     const asset reserved{balance.reserved, d.get_dascoin_asset_id()};
     FC_ASSERT( _to_debit <= reserved, "Not enough reserved balance on user account ${a}, left ${l}, needed ${n}", ("a", op.account)("l", d.to_pretty_string(reserved))("n", d.to_pretty_string(_to_debit)) );
@@ -358,7 +358,7 @@ namespace graphene { namespace chain {
       _to_credit = asset { tmp.amount * DASCOIN_DEFAULT_ASSET_PRECISION / *(sell_prices.begin()), d.get_dascoin_asset_id() };
     }
     else
-      _to_credit = tmp * dgpo.last_dascoin_price;
+      _to_credit = tmp * d.get_last_dascoin_price();
 
     FC_ASSERT( _to_credit <= balance, "Not enough balance on clearing account ${a}, left ${l}, needed ${n}", ("a", op.clearing_account)("l", d.to_pretty_string(balance))("n", d.to_pretty_string(_to_credit)) );
 
@@ -27,6 +27,7 @@
 #include <graphene/chain/hardfork.hpp>
 
 #include <graphene/chain/block_summary_object.hpp>
+#include <graphene/chain/das33_evaluator.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
@@ -102,7 +103,7 @@ optional<signed_block_with_virtual_operations> database::fetch_block_with_virtua
 
          if( jk == vop_id)
          {
-            ret_v.virtual_operations.push_back(itr->op);
+            ret_v.virtual_operations.push_back(itr->op.to_operation());
          }
       }
       itr++;
@@ -263,21 +264,36 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
    if( !_pending_tx_session.valid() )
+   {
       _pending_tx_session = _undo_db.start_undo_session();
+      reset_block_template();
+   }
 
    // Create a temporary undo session as a child of _pending_tx_session.
    // The temporary session will be discarded by the destructor if
    // _apply_transaction fails.  If we make it to merge(), we
    // apply the changes.
 
+   // Pledge-only transactions are checked against project state before their signatures are verified, so the
+   // burst of pledges at a das33 launch is turned away cheaply once a phase or a user's cap is exhausted.
+   // Pledges only ever use up supply, caps and balance, so checking them all against the state before the
+   // transaction cannot reject one which would have been accepted.
+   const auto is_pledge = [](const operation& op) { return op.which() == operation::tag<das33_pledge_asset_operation>::value; };
+   if( !trx.operations.empty() && std::all_of( trx.operations.begin(), trx.operations.end(), is_pledge ) )
+      for( const auto& op : trx.operations )
+         das33_pledge_precheck( op.get<das33_pledge_asset_operation>(), *this );
+
    auto temp_session = _undo_db.start_undo_session();
+   const auto apply_start = fc::time_point::now();
    auto processed_trx = _apply_transaction( trx );
    _pending_tx.push_back(processed_trx);
+   _pending_tx_apply_time.push_back( fc::time_point::now() - apply_start );
 
    // notify_changed_objects();
 
    // The transaction applied successfully. Merge its changes into the pending block session.
    temp_session.merge();
+   extend_block_template( processed_trx );
 
    // notify anyone listening to pending transactions
    on_pending_transaction( trx );
@@ -365,6 +381,30 @@ signed_block database::_generate_block(
    size_t total_block_size = max_block_header_size;
 
    signed_block pending_block;
+   const fc::time_point generation_start = fc::time_point::now();
+
+   if( block_template_usable( skip ) )
+   {
+      //
+      // Every transaction of the template was applied on top of the current
+      // head block, in order and with at least the checks requested now, so
+      // re-applying them would produce the same results.
+      //
+      const auto count = _block_template.merkle_digests.size();
+      pending_block.transactions.assign( _pending_tx.begin(), _pending_tx.begin() + count );
+      if( _pending_tx.size() > count )
+         wlog( "Postponed ${n} transactions due to block size limit", ("n", _pending_tx.size() - count) );
+
+      _pending_tx_session.reset();
+
+      pending_block.previous = head_block_id();
+      pending_block.timestamp = when;
+      pending_block.transaction_merkle_root = signed_block::calculate_merkle_root( _block_template.merkle_digests );
+      pending_block.witness = witness_id;
+
+      update_block_production_stats( generation_start, 0 );
+      return finalize_generated_block( pending_block, block_signing_private_key, skip );
+   }
 
    //
    // The following code throws away existing pending_tx_session and
@@ -380,10 +420,14 @@ signed_block database::_generate_block(
    _pending_tx_session.reset();
    _pending_tx_session = _undo_db.start_undo_session();
 
+   assert( _pending_tx_apply_time.size() == _pending_tx.size() );
+   const fc::microseconds time_budget = get_node_properties().block_production_time_budget;
    uint64_t postponed_tx_count = 0;
+   uint64_t deferred_tx_count = 0;
    // pop pending state (reset to head block state)
-   for( const processed_transaction& tx : _pending_tx )
+   for( size_t i = 0; i < _pending_tx.size(); ++i )
    {
+      const processed_transaction& tx = _pending_tx[i];
       size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
 
       // postpone transaction if it would make block too big
@@ -393,10 +437,21 @@ signed_block database::_generate_block(
          continue;
       }
 
+      // defer transaction if applying it, judging by the time it took when it was pushed, would exceed the
+      // time budget; the first transaction of a block is always tried so expensive ones are not starved
+      if( time_budget.count() > 0 && !pending_block.transactions.empty() &&
+          (fc::time_point::now() - generation_start) + _pending_tx_apply_time[i] > time_budget )
+      {
+         deferred_tx_count++;
+         continue;
+      }
+
       try
       {
          auto temp_session = _undo_db.start_undo_session();
+         const auto apply_start = fc::time_point::now();
          processed_transaction ptx = _apply_transaction( tx );
+         _pending_tx_apply_time[i] = fc::time_point::now() - apply_start;
          temp_session.merge();
 
          // We have to recompute pack_size(ptx) because it may be different
@@ -416,6 +471,12 @@ signed_block database::_generate_block(
    {
       wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
    }
+   if( deferred_tx_count > 0 )
+   {
+      wlog( "Deferred ${n} transactions due to the block production time budget of ${b} ms",
+            ("n", deferred_tx_count)("b", time_budget.count() / 1000) );
+   }
+   update_block_production_stats( generation_start, deferred_tx_count );
 
    _pending_tx_session.reset();
 
@@ -430,6 +491,13 @@ signed_block database::_generate_block(
    pending_block.transaction_merkle_root = pending_block.calculate_merkle_root();
    pending_block.witness = witness_id;
 
+   return finalize_generated_block( pending_block, block_signing_private_key, skip );
+} FC_CAPTURE_AND_RETHROW( (witness_id) ) }
+
+signed_block database::finalize_generated_block( signed_block& pending_block,
+                                                 const fc::ecc::private_key& block_signing_private_key,
+                                                 uint32_t skip )
+{
    if( !(skip & skip_witness_signature) )
       pending_block.sign( block_signing_private_key );
 
@@ -442,7 +510,67 @@ signed_block database::_generate_block(
    push_block( pending_block, skip );
 
    return pending_block;
-} FC_CAPTURE_AND_RETHROW( (witness_id) ) }
+}
+
+void database::update_block_production_stats( fc::time_point generation_start, uint64_t deferred_tx_count )
+{
+   const fc::microseconds elapsed = fc::time_point::now() - generation_start;
+   ++_block_production_stats.blocks_generated;
+   if( deferred_tx_count > 0 )
+   {
+      ++_block_production_stats.blocks_over_budget;
+      _block_production_stats.transactions_deferred += deferred_tx_count;
+   }
+   _block_production_stats.last_generation_time = elapsed;
+   if( elapsed > _block_production_stats.max_generation_time )
+      _block_production_stats.max_generation_time = elapsed;
+}
+
+void database::record_block_broadcast_latency( fc::microseconds latency )
+{
+   _block_production_stats.last_broadcast_latency = latency;
+   if( latency > _block_production_stats.max_broadcast_latency )
+      _block_production_stats.max_broadcast_latency = latency;
+}
+
+void database::reset_block_template()
+{
+   static const size_t max_block_header_size = fc::raw::pack_size( signed_block_header() ) + 4;
+
+   _block_template = block_template();
+   // the template can only describe a pending state which starts out empty
+   _block_template.valid = _pending_tx.empty();
+   _block_template.previous = head_block_id();
+   _block_template.block_size = max_block_header_size;
+}
+
+void database::extend_block_template( const processed_transaction& ptx )
+{
+   if( !_block_template.valid || _block_template.full )
+      return;
+
+   const size_t new_block_size = _block_template.block_size + fc::raw::pack_size( ptx );
+   if( new_block_size >= get_global_properties().parameters.maximum_block_size )
+   {
+      // later transactions were applied on top of this one, so none of them can be added either
+      _block_template.full = true;
+      return;
+   }
+
+   assert( _pending_tx.size() == _block_template.merkle_digests.size() + 1 );
+   _block_template.block_size = new_block_size;
+   _block_template.skip |= get_node_properties().skip_flags;
+   _block_template.merkle_digests.push_back( ptx.merkle_digest() );
+}
+
+bool database::block_template_usable( uint32_t skip )const
+{
+   return _block_template.valid
+       && _pending_tx_session.valid()
+       && _block_template.previous == head_block_id()
+       && ( _block_template.skip & ~skip ) == 0
+       && _block_template.merkle_digests.size() <= _pending_tx.size();
+}
 
 /**
  * Removes the most recent block from the database and
@@ -466,6 +594,7 @@ void database::clear_pending()
 { try {
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
+   _pending_tx_apply_time.clear();
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -524,7 +653,7 @@ void database::applied_ops_to_virtual_ops( )
       if(ooho.valid())
       {
          operation_history_object& oho = *ooho;
-         if( operation_type_limits::is_virtual_operation(oho.op) )
+         if( operation_type_limits::is_virtual_operation(oho.op.which()) )
          {
             vector<optional< operation_history_object > >::iterator it = std::find_if(_virtual_ops.begin(),_virtual_ops.end(),
                   [&oho](optional<operation_history_object > const& e){
@@ -554,6 +683,9 @@ void database::_apply_block( const signed_block& next_block )
    applied_ops_to_virtual_ops();
    _applied_ops.clear();
 
+   // Confidential proofs are verified on worker threads while the transactions before them are applied:
+   _confidential_proofs.precompute( next_block );
+
    FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
 
    const witness_object& signing_witness = validate_block_header(skip, next_block);
@@ -600,7 +732,10 @@ void database::_apply_block( const signed_block& next_block )
    update_witnesses();
    update_witness_schedule();
 
-   reset_spending_limits();
+   const bool use_maintenance_tasks = head_block_time() >= HARDFORK_MAINTENANCE_TASKS_TIME;
+
+   if ( !use_maintenance_tasks )
+      reset_spending_limits();
 
    if ( global_props.parameters.enable_dascoin_queue )
       mint_dascoin_rewards();
@@ -608,7 +743,10 @@ void database::_apply_block( const signed_block& next_block )
    if ( global_props.daspay_parameters.clearing_enabled )
      daspay_clearing_start();
 
-   if ( global_props.delayed_operations_resolver_enabled )
+   // Spending limit resets, upgrades and delayed operations are spread over consecutive blocks:
+   if ( use_maintenance_tasks )
+     run_maintenance_tasks();
+   else if ( global_props.delayed_operations_resolver_enabled )
      resolve_delayed_operations();
 
    if( !_node_property_object.debug_updates.empty() )
@@ -637,7 +775,15 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    uint32_t skip = get_node_properties().skip_flags;
 
    if( true || !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
-      trx.validate();
+   {
+      if( confidential_proof_verifier::has_proofs( trx ) )
+      {
+         confidential_proof_verifier::validate_without_proofs( trx );
+         _confidential_proofs.verify( trx );
+      }
+      else
+         trx.validate();
+   }
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
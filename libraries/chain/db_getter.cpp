@@ -97,6 +97,67 @@ const dynamic_global_property_object&database::get_dynamic_global_properties() c
    return get( dynamic_global_property_id_type() );
 }
 
+const last_price_object* database::find_last_price( asset_id_type base, asset_id_type quote )const
+{
+   return _last_prices->find( market_key{ base, quote } );
+}
+
+const external_price_object* database::find_external_price( asset_id_type base, asset_id_type quote )const
+{
+   return _external_prices->find( market_key{ base, quote } );
+}
+
+void database::set_last_price( const market_key& market, const price& p )
+{
+   const time_point_sec timestamp = head_block_time();
+   const auto* lpo = find_last_price( market.base, market.quote );
+   if( lpo != nullptr )
+      modify( *lpo, [&p, timestamp]( last_price_object& o ) {
+         o.last_price = p;
+         o.timestamp = timestamp;
+      });
+   else
+      create<last_price_object>( [&market, &p, timestamp]( last_price_object& o ) {
+         o.market = market;
+         o.last_price = p;
+         o.timestamp = timestamp;
+      });
+}
+
+void database::set_external_price( const market_key& market, const price& p )
+{
+   const time_point_sec timestamp = head_block_time();
+   const auto* epo = find_external_price( market.base, market.quote );
+   if( epo != nullptr )
+      modify( *epo, [&p, timestamp]( external_price_object& o ) {
+         o.external_price = p;
+         o.timestamp = timestamp;
+      });
+   else
+      create<external_price_object>( [&market, &p, timestamp]( external_price_object& o ) {
+         o.market = market;
+         o.external_price = p;
+         o.timestamp = timestamp;
+      });
+}
+
+price database::get_last_dascoin_price()const
+{
+   const auto* lpo = find_last_price( get_dascoin_asset_id(), get_web_asset_id() );
+   return lpo != nullptr ? lpo->last_price : get_dynamic_global_properties().last_dascoin_price;
+}
+
+price database::get_last_btc_price()const
+{
+   const auto* lpo = find_last_price( get_btc_asset_id(), get_web_asset_id() );
+   return lpo != nullptr ? lpo->last_price : get_dynamic_global_properties().last_btc_price;
+}
+
+price database::get_external_btc_price()const
+{
+   return get_dynamic_global_properties().external_btc_price;
+}
+
 const fee_schedule&  database::current_fee_schedule()const
 {
    return get_global_properties().parameters.current_fees;
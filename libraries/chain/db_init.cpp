@@ -34,11 +34,13 @@
 #include <graphene/chain/chain_property_object.hpp>
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/confidential_object.hpp>
+#include <graphene/chain/dascoin_twap_object.hpp>
 #include <graphene/chain/fba_object.hpp>
 #include <graphene/chain/frequency_history_record_object.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/issued_asset_record_object.hpp>
 #include <graphene/chain/license_objects.hpp>
+#include <graphene/chain/maintenance_task_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
@@ -302,6 +304,17 @@ void database::initialize_evaluators()
    register_evaluator<das33_set_use_market_price_for_token_evaluator>();
 }
 
+void database::enable_account_name_search()
+{
+   if( _account_name_search != nullptr )
+      return;
+   auto& acnt_index = get_mutable_index_type< primary_index<account_index> >();
+   auto search_index = acnt_index.add_secondary_index<account_name_search_index>();
+   // accounts which are already loaded are not reported to a newly added index
+   acnt_index.inspect_all_objects( [&]( const object& o ) { search_index->object_inserted( o ); } );
+   _account_name_search = search_index;
+}
+
 void database::initialize_indexes()
 {
    reset_indexes();
@@ -318,8 +331,12 @@ void database::initialize_indexes()
    add_index< primary_index<committee_member_index> >();
    add_index< primary_index<witness_index> >();
    add_index< primary_index<limit_order_index > >();
-   add_index< primary_index<last_price_index > >();
-   add_index< primary_index<external_price_index > >();
+   auto last_price_idx = add_index< primary_index<last_price_index > >();
+   last_price_idx->add_secondary_index<last_price_registry>();
+   _last_prices = &last_price_idx->get_secondary_index<last_price_registry>();
+   auto external_price_idx = add_index< primary_index<external_price_index > >();
+   external_price_idx->add_secondary_index<external_price_registry>();
+   _external_prices = &external_price_idx->get_secondary_index<external_price_registry>();
    add_index< primary_index<call_order_index > >();
 
    auto prop_index = add_index< primary_index<proposal_index > >();
@@ -362,8 +379,12 @@ void database::initialize_indexes()
    add_index<primary_index<daspay_authority_index>>();
    add_index<primary_index<payment_service_provider_index>>();
    add_index<primary_index<das33_project_index>>();
-   add_index<primary_index<das33_pledge_holder_index>>();
+   auto das33_pledge_index = add_index<primary_index<das33_pledge_holder_index>>();
+   das33_pledge_index->add_secondary_index<das33_pledge_totals_index>();
    add_index<primary_index<delayed_operations_index>>();
+   add_index<primary_index<maintenance_task_index>>();
+   add_index<primary_index<dascoin_twap_index>>();
+   add_index<primary_index<dascoin_twap_bucket_index>>();
 }
 
 account_id_type database::initialize_chain_authority(const string& kind_name, const string& acc_name)
@@ -854,6 +854,13 @@ void database::perform_upgrades()
          obj.num_of_executions++;
       });
 
+      // The accounts are upgraded by the maintenance task scheduler over the following blocks:
+      if ( head_block_time() >= HARDFORK_MAINTENANCE_TASKS_TIME )
+      {
+         trigger_maintenance_task(maintenance_task_kind::perform_upgrades, it->id);
+         continue;
+      }
+
       last_upgrade = *it;
       perform_upgrades_helper upgrades_helper(*this, *it);
       perform_helpers<account_index, by_name>(std::tie(upgrades_helper));
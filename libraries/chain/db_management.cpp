@@ -175,6 +175,12 @@ void database::open(
                     ("last_block->id", last_block)("head_block_id",head_block_num()) );
          reindex( data_dir );
       }
+      else if( !_undo_db.enabled() )
+      {
+         // Object state was loaded from disk with no blocks to replay on top of it,
+         // so neither init_genesis() nor reindex() turned undo tracking back on.
+         _undo_db.enable();
+      }
    }
    FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
 }
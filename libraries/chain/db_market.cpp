@@ -441,45 +441,12 @@ void database::push_fill_order_operation( const fill_order_operation &fill_order
     push_applied_operation(fill_order);
     if (set_price)
     {
-        // Update dascoin price only if market is DSC:WEBEUR.
-        if (fill_order.pays.asset_id == get_dascoin_asset_id() && fill_order.receives.asset_id == get_web_asset_id())
-        {
-            // This is the same as in market history.
-            price dsc_price = fill_order.pays / fill_order.receives;
-            modify(get_dynamic_global_properties(), [dsc_price](dynamic_global_property_object &dgpo) {
-                dgpo.last_dascoin_price = dsc_price;
-            });
-        }
-        // Update bitcoin price only if market is BTC:WEBEUR.
-        if (fill_order.pays.asset_id == get_btc_asset_id() && fill_order.receives.asset_id == get_web_asset_id())
-        {
-            // This is the same as in market history.
-            price btc_price = fill_order.pays / fill_order.receives;
-            modify(get_dynamic_global_properties(), [btc_price](dynamic_global_property_object &dgpo) {
-                dgpo.last_btc_price = btc_price;
-            });
-        }
-
-        price last_price = fill_order.pays / fill_order.receives;
-        time_point_sec timestamp = head_block_time();
-
-        const auto& idx = get_index_type<last_price_index>().indices().get<by_market_key>();
-        auto itr = idx.find(market_key{base:fill_order.pays.asset_id, quote:fill_order.receives.asset_id});
-        if (itr != idx.end())
-        {
-          modify(*itr, [last_price, timestamp] (last_price_object &lpo) {
-            lpo.last_price = last_price;
-            lpo.timestamp = timestamp;
-          });
-        }
-        else
-        {
-          create<last_price_object>([&](last_price_object &lpo) {
-            lpo.market = market_key{base:fill_order.pays.asset_id, quote:fill_order.receives.asset_id};
-            lpo.last_price = last_price;
-            lpo.timestamp = timestamp;
-          });
-        }
+        // DSC:WEBEUR and BTC:WEBEUR are recorded like any other market, see get_last_dascoin_price().
+        set_last_price(market_key{base:fill_order.pays.asset_id, quote:fill_order.receives.asset_id},
+                       fill_order.pays / fill_order.receives);
+        if (fill_order.pays.asset_id == get_dascoin_asset_id() && fill_order.receives.asset_id == get_web_asset_id()
+            && head_block_time() >= HARDFORK_DASCOIN_TWAP_TIME)
+            record_dascoin_twap_price(fill_order.pays, fill_order.receives);
     }
 }
 /**
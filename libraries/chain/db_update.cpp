@@ -26,13 +26,16 @@
 #include <graphene/chain/db_with.hpp>
 
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/dascoin_twap_object.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/license_objects.hpp>
+#include <graphene/chain/maintenance_task_object.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/queue_objects.hpp>
 #include <graphene/chain/transaction_object.hpp>
+#include <graphene/chain/upgrade_event_object.hpp>
 #include <graphene/chain/withdraw_permission_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 
@@ -512,10 +515,10 @@ void database::reset_spending_limits()
   {
     // Reset spending limit for each account:
     const auto& account_idx = get_index_type<account_index>().indices().get<by_id>();
+    const price dascoin_price = get_spending_limit_price();
     for ( const auto& account : account_idx )
     {
-      // TODO: price should be a weekly average price, not the last price at the moment of sampling.
-      auto dsc_limit = get_dascoin_limit(account, dgpo.last_dascoin_price);
+      auto dsc_limit = get_dascoin_limit(account, dascoin_price);
       if ( dsc_limit.valid() )
       {
         // Set the limit on the account balance object:
@@ -525,7 +528,7 @@ void database::reset_spending_limits()
 
     // Set the time of the next limit reset:
     modify(dgpo, [&](dynamic_global_property_object& dgpo){
-      dgpo.last_daily_dascoin_price = dgpo.last_dascoin_price;
+      dgpo.last_daily_dascoin_price = dascoin_price;
       uint32_t now_sec = head_block_time().sec_since_epoch();
       uint32_t next_interval = (now_sec / params.limit_interval_elapse_time_seconds) *
                                 params.limit_interval_elapse_time_seconds + params.limit_interval_elapse_time_seconds;
@@ -732,4 +735,319 @@ void database::resolve_delayed_operations()
 
 } FC_CAPTURE_AND_RETHROW() }
 
+const dascoin_twap_object& database::get_dascoin_twap()
+{
+  const auto& idx = get_index_type<dascoin_twap_index>().indices();
+  if ( !idx.empty() )
+    return *idx.begin();
+
+  // Start from the last trade price, so the average is defined from the first block on:
+  const price last = get_last_dascoin_price();
+  const asset_id_type dascoin_id = get_dascoin_asset_id();
+  const uint64_t start_price = last.base.asset_id == dascoin_id
+                               ? dascoin_twap_object::to_twap_price(last.base, last.quote)
+                               : dascoin_twap_object::to_twap_price(last.quote, last.base);
+  return create<dascoin_twap_object>([&](dascoin_twap_object& dto){
+    dto.last_price = start_price;
+    dto.last_update = head_block_time();
+  });
+}
+
+const dascoin_twap_bucket_object& database::get_dascoin_twap_bucket(uint32_t slot)
+{
+  const auto& idx = get_index_type<dascoin_twap_bucket_index>().indices().get<by_slot>();
+  const auto itr = idx.find(slot);
+  if ( itr != idx.end() )
+    return *itr;
+
+  return create<dascoin_twap_bucket_object>([slot](dascoin_twap_bucket_object& dtbo){
+    dtbo.slot = slot;
+  });
+}
+
+void database::accrue_dascoin_twap(time_point_sec now)
+{
+  const auto& twap = get_dascoin_twap();
+  if ( now <= twap.last_update )
+    return;
+
+  const uint32_t window = DASCOIN_TWAP_BUCKET_SECONDS * DASCOIN_TWAP_BUCKET_COUNT;
+  uint32_t from = twap.last_update.sec_since_epoch();
+  const uint32_t to = now.sec_since_epoch();
+  // Anything older than the window would be recycled right away:
+  if ( to - from > window )
+    from = to - window;
+
+  uint64_t window_weighted_sum = twap.window_weighted_sum;
+  uint64_t window_seconds = twap.window_seconds;
+  // Every bucket between the two periods is visited, so no bucket older than the window survives:
+  while ( from < to )
+  {
+    const uint32_t period = from / DASCOIN_TWAP_BUCKET_SECONDS;
+    const uint32_t end = std::min<uint64_t>(to, (uint64_t(period) + 1) * DASCOIN_TWAP_BUCKET_SECONDS);
+    const uint32_t seconds = end - from;
+    const uint64_t weighted = twap.last_price * seconds;
+    modify(get_dascoin_twap_bucket(period % DASCOIN_TWAP_BUCKET_COUNT), [&](dascoin_twap_bucket_object& bucket){
+      if ( bucket.period != period )
+      {
+        window_weighted_sum -= bucket.weighted_sum;
+        window_seconds -= bucket.seconds;
+        bucket.period = period;
+        bucket.weighted_sum = 0;
+        bucket.seconds = 0;
+      }
+      bucket.weighted_sum += weighted;
+      bucket.seconds += seconds;
+    });
+    window_weighted_sum += weighted;
+    window_seconds += seconds;
+    from = end;
+  }
+
+  modify(twap, [&](dascoin_twap_object& dto){
+    dto.window_weighted_sum = window_weighted_sum;
+    dto.window_seconds = window_seconds;
+    dto.last_update = now;
+  });
+}
+
+void database::record_dascoin_twap_price(const asset& dascoin_amount, const asset& web_amount)
+{
+  const uint64_t twap_price = dascoin_twap_object::to_twap_price(dascoin_amount, web_amount);
+  if ( twap_price == 0 )
+    return;
+  const time_point_sec now = head_block_time();
+  accrue_dascoin_twap(now);
+  modify(get_dascoin_twap(), [twap_price, now](dascoin_twap_object& dto){
+    dto.last_price = twap_price;
+    dto.last_update = now;
+  });
+}
+
+price database::update_dascoin_twap_price()
+{
+  accrue_dascoin_twap(head_block_time());
+  const uint64_t average = get_dascoin_twap().average();
+  if ( average == 0 )
+    return get_last_dascoin_price();
+  return dascoin_twap_object::from_twap_price(average, get_dascoin_asset_id(), get_web_asset_id());
+}
+
+price database::get_spending_limit_price()
+{
+  if ( head_block_time() >= HARDFORK_DASCOIN_TWAP_TIME )
+    return update_dascoin_twap_price();
+  return get_last_dascoin_price();
+}
+
+const maintenance_task_object& database::get_maintenance_task(maintenance_task_kind kind)
+{
+  const auto& idx = get_index_type<maintenance_task_index>().indices().get<by_kind>();
+  auto it = idx.find(kind);
+  if ( it != idx.end() )
+    return *it;
+
+  // Tasks are created on first use, which happens in the same block on every node:
+  uint32_t budget = 0;
+  switch ( kind )
+  {
+    case maintenance_task_kind::reset_spending_limits:
+      budget = DASCOIN_MAINTENANCE_TASK_RESET_SPENDING_LIMITS_BUDGET;
+      break;
+    case maintenance_task_kind::perform_upgrades:
+      budget = DASCOIN_MAINTENANCE_TASK_PERFORM_UPGRADES_BUDGET;
+      break;
+    case maintenance_task_kind::resolve_delayed_operations:
+      budget = DASCOIN_MAINTENANCE_TASK_RESOLVE_DELAYED_OPERATIONS_BUDGET;
+      break;
+    default:
+      FC_ASSERT( false, "Unknown maintenance task kind ${k}", ("k", kind) );
+  }
+  return create<maintenance_task_object>([&](maintenance_task_object& mto){
+    mto.kind = kind;
+    mto.budget_per_block = budget;
+  });
+}
+
+void database::trigger_maintenance_task(maintenance_task_kind kind, object_id_type subject)
+{ try {
+  const auto& task = get_maintenance_task(kind);
+
+  // The front of the queue is the run in progress, so only the waiting runs are checked:
+  if ( task.queue.size() > 1 && std::find(task.queue.begin() + 1, task.queue.end(), subject) != task.queue.end() )
+    return;
+
+  modify(task, [&](maintenance_task_object& mto){
+    mto.queue.push_back(subject);
+  });
+} FC_CAPTURE_AND_RETHROW( (kind)(subject) ) }
+
+namespace {
+
+  /// Where a maintenance task run continues, for each order the runs walk their index in:
+  template<typename Tag>
+  struct maintenance_task_cursor;
+
+  template<>
+  struct maintenance_task_cursor<by_id>
+  {
+    template<typename Index>
+    static typename Index::const_iterator lower_bound(const Index& idx, const maintenance_task_object& task)
+    { return idx.lower_bound(task.cursor); }
+
+    template<typename Object>
+    static void store(maintenance_task_object& mto, const Object* next)
+    { mto.cursor = next ? next->id : object_id_type(); }
+  };
+
+  template<>
+  struct maintenance_task_cursor<by_name>
+  {
+    template<typename Index>
+    static typename Index::const_iterator lower_bound(const Index& idx, const maintenance_task_object& task)
+    { return idx.lower_bound(task.name_cursor); }
+
+    template<typename Object>
+    static void store(maintenance_task_object& mto, const Object* next)
+    { mto.name_cursor = next ? next->name : string(); }
+  };
+
+}
+
+template<typename IndexType, typename Tag, typename Lambda>
+bool database::process_maintenance_task_items(const maintenance_task_object& task, Lambda process)
+{
+  typedef maintenance_task_cursor<Tag> cursor_type;
+  const auto& idx = get_index_type<IndexType>().indices().template get<Tag>();
+  auto it = cursor_type::lower_bound(idx, task);
+  uint64_t count = 0;
+
+  while ( it != idx.end() && (task.budget_per_block == 0 || count < task.budget_per_block) )
+  {
+    // Advance first, the processed item may be removed:
+    const auto& item = *it++;
+    process(item);
+    ++count;
+  }
+
+  const bool finished = it == idx.end();
+  const auto* next = finished ? nullptr : &*it;
+  modify(task, [&](maintenance_task_object& mto){
+    cursor_type::store(mto, next);
+    mto.processed += count;
+  });
+  return finished;
+}
+
+bool database::run_maintenance_task_step(const maintenance_task_object& task)
+{
+  switch ( task.kind )
+  {
+    case maintenance_task_kind::reset_spending_limits:
+    {
+      // The price is sampled once, when the run starts:
+      const price& run_price = task.run_price;
+      return process_maintenance_task_items<account_index, by_id>(task, [&](const account_object& account){
+        auto dsc_limit = get_dascoin_limit(account, run_price);
+        if ( dsc_limit.valid() )
+          adjust_balance_limit(account, get_dascoin_asset_id(), *dsc_limit, true);
+      });
+    }
+    case maintenance_task_kind::perform_upgrades:
+    {
+      // The upgrade event can be removed while its subsequent executions are still pending:
+      const auto* upgrade = find(upgrade_event_id_type(task.queue.front()));
+      if ( upgrade == nullptr )
+        return true;
+      // Accounts are upgraded in the order of their names, as they were before the scheduler, and only those which
+      // existed when the run started:
+      return process_maintenance_task_items<account_index, by_name>(task, [&](const account_object& account){
+        if ( account.id < task.first_new_id )
+          perform_upgrades(account, *upgrade);
+      });
+    }
+    case maintenance_task_kind::resolve_delayed_operations:
+    {
+      return process_maintenance_task_items<delayed_operations_index, by_id>(task, [&](const delayed_operation_object& dop){
+        if ( dop.issued_time + dop.skip <= head_block_time() )
+        {
+          dop.op.visit(op_visitor(*this));
+          remove(dop);
+        }
+      });
+    }
+    default:
+      break;
+  }
+  FC_ASSERT( false, "Unknown maintenance task kind ${k}", ("k", task.kind) );
+  return true;
+}
+
+void database::run_maintenance_tasks()
+{ try {
+  const auto& gpo = get_global_properties();
+  const auto& dgpo = get_dynamic_global_properties();
+  const auto& params = gpo.parameters;
+
+  // Trigger the periodic tasks. Their next times are set at once, so a run which takes several blocks is not
+  // triggered again:
+  if ( dgpo.next_spend_limit_reset <= head_block_time() )
+  {
+    const price dascoin_price = get_spending_limit_price();
+    modify(dgpo, [&](dynamic_global_property_object& dgpo){
+      dgpo.last_daily_dascoin_price = dascoin_price;
+      uint32_t now_sec = head_block_time().sec_since_epoch();
+      uint32_t next_interval = (now_sec / params.limit_interval_elapse_time_seconds) *
+                                params.limit_interval_elapse_time_seconds + params.limit_interval_elapse_time_seconds;
+      if (fc::time_point_sec(dgpo.next_spend_limit_reset) == fc::time_point_sec(next_interval))
+        dgpo.next_spend_limit_reset = fc::time_point_sec(next_interval) + params.limit_interval_elapse_time_seconds;
+      else
+        dgpo.next_spend_limit_reset = fc::time_point_sec(next_interval);
+    });
+    trigger_maintenance_task(maintenance_task_kind::reset_spending_limits, dgpo.id);
+  }
+
+  if ( gpo.delayed_operations_resolver_enabled && dgpo.next_delayed_operations_resolver_time <= head_block_time() )
+  {
+    modify(dgpo, [&](dynamic_global_property_object& dgpo){
+      dgpo.next_delayed_operations_resolver_time = head_block_time() + gpo.delayed_operations_resolver_interval_time_seconds;
+    });
+    trigger_maintenance_task(maintenance_task_kind::resolve_delayed_operations, dgpo.id);
+  }
+
+  // Upgrade events are triggered at maintenance, see perform_upgrades().
+
+  const auto& idx = get_index_type<maintenance_task_index>().indices().get<by_kind>();
+  for ( const auto& task : idx )
+  {
+    if ( !task.running() )
+      continue;
+
+    if ( task.started_at_block == 0 )
+      modify(task, [&](maintenance_task_object& mto){
+        mto.started_at_block = head_block_num();
+        if ( mto.kind == maintenance_task_kind::reset_spending_limits )
+          mto.run_price = dgpo.last_daily_dascoin_price;
+        else if ( mto.kind == maintenance_task_kind::perform_upgrades )
+          mto.first_new_id = get_index_type<account_index>().get_next_id();
+      });
+
+    if ( !run_maintenance_task_step(task) )
+      continue;
+
+    dlog("Maintenance task ${k} finished ${n} items in ${b} blocks",
+         ("k", task.kind)("n", task.processed)("b", head_block_num() - task.started_at_block + 1));
+    modify(task, [&](maintenance_task_object& mto){
+      mto.queue.erase(mto.queue.begin());
+      mto.cursor = object_id_type();
+      mto.name_cursor = string();
+      mto.run_price = price();
+      mto.first_new_id = object_id_type();
+      mto.started_at_block = 0;
+      mto.processed = 0;
+    });
+  }
+
+} FC_CAPTURE_AND_RETHROW() }
+
 } }  // namespace database::chain
@@ -0,0 +1,349 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/chain/impacted_accounts.hpp>
+#include <graphene/chain/protocol/authority.hpp>
+
+#include <boost/preprocessor/seq/for_each.hpp>
+
+namespace graphene { namespace chain {
+
+namespace detail {
+
+   template<typename Sink>
+   void add_impacted( const account_id_type& id, Sink& sink )
+   {
+      sink.insert( id );
+   }
+
+   template<typename Sink>
+   void add_impacted( const authority& a, Sink& sink )
+   {
+      for( const auto& item : a.account_auths )
+         sink.insert( item.first );
+   }
+
+   template<typename T, typename Sink>
+   void add_impacted( const optional<T>& o, Sink& sink )
+   {
+      if( o.valid() )
+         add_impacted( *o, sink );
+   }
+
+   template<typename T, typename Sink>
+   void add_impacted( const vector<T>& v, Sink& sink )
+   {
+      for( const auto& item : v )
+         add_impacted( item, sink );
+   }
+
+   /**
+    * Lists the members of an operation which name impacted accounts.  Every operation type needs an entry, so that a
+    * new operation cannot silently leave accounts out of their history; operations which impact no accounts besides
+    * their required authorities are listed with GRAPHENE_NO_IMPACTED_ACCOUNTS.
+    */
+   template<typename Operation>
+   struct impacted_account_fields
+   {
+      static_assert( sizeof(Operation) == 0, "every operation type needs an impacted_account_fields entry" );
+   };
+
+#define GRAPHENE_IMPACTED_ACCOUNT_FIELD( r, data, FIELD ) add_impacted( op.FIELD, sink );
+
+#define GRAPHENE_IMPACTED_ACCOUNTS( OPERATION, FIELDS )                           \
+   template<>                                                                     \
+   struct impacted_account_fields<OPERATION>                                      \
+   {                                                                              \
+      template<typename Sink>                                                     \
+      static void add( const OPERATION& op, Sink& sink )                          \
+      {                                                                           \
+         BOOST_PP_SEQ_FOR_EACH( GRAPHENE_IMPACTED_ACCOUNT_FIELD, _, FIELDS )      \
+      }                                                                           \
+   };
+
+#define GRAPHENE_NO_IMPACTED_ACCOUNTS( OPERATION )                                \
+   template<>                                                                     \
+   struct impacted_account_fields<OPERATION>                                      \
+   {                                                                              \
+      template<typename Sink>                                                     \
+      static void add( const OPERATION&, Sink& ) {}                               \
+   };
+
+   // Graphene operations:
+   GRAPHENE_IMPACTED_ACCOUNTS( transfer_operation, (to) )
+   GRAPHENE_IMPACTED_ACCOUNTS( limit_order_cancel_operation, (fee_paying_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( fill_order_operation, (account_id) )
+   GRAPHENE_IMPACTED_ACCOUNTS( account_create_operation, (registrar)(referrer)(owner)(active) )
+   GRAPHENE_IMPACTED_ACCOUNTS( account_update_operation, (account)(owner)(active) )
+   GRAPHENE_IMPACTED_ACCOUNTS( account_whitelist_operation, (account_to_list) )
+   GRAPHENE_IMPACTED_ACCOUNTS( account_transfer_operation, (new_owner) )
+   GRAPHENE_IMPACTED_ACCOUNTS( asset_update_operation, (new_issuer) )
+   GRAPHENE_IMPACTED_ACCOUNTS( asset_issue_operation, (issue_to_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( asset_settle_cancel_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( witness_create_operation, (witness_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( witness_update_operation, (witness_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( withdraw_permission_create_operation, (authorized_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( withdraw_permission_update_operation, (authorized_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( withdraw_permission_claim_operation, (withdraw_from_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( withdraw_permission_delete_operation, (authorized_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( committee_member_create_operation, (committee_member_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( committee_member_update_operation, (committee_member_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( vesting_balance_create_operation, (owner) )
+   GRAPHENE_IMPACTED_ACCOUNTS( override_transfer_operation, (to)(from)(issuer) )
+   GRAPHENE_IMPACTED_ACCOUNTS( fba_distribute_operation, (account_id) )
+
+   // Accounts and authorities:
+   GRAPHENE_IMPACTED_ACCOUNTS( remove_vault_limit_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( board_update_chain_authority_operation, (account)(committee_member_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( tether_accounts_operation, (wallet_account)(vault_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( change_public_keys_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( set_roll_back_enabled_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( roll_back_public_keys_operation, (authority)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( set_chain_authority_operation, (issuer)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_global_parameters_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_delayed_operations_resolver_parameters_operation, (authority) )
+
+   // Fees:
+   GRAPHENE_IMPACTED_ACCOUNTS( change_operation_fee_operation, (issuer) )
+   GRAPHENE_IMPACTED_ACCOUNTS( change_fee_pool_account_operation, (issuer)(fee_pool_account_id) )
+   GRAPHENE_IMPACTED_ACCOUNTS( fee_pool_cycles_submit_operation, (issuer) )
+
+   // Licenses, cycles and the reward queue:
+   GRAPHENE_IMPACTED_ACCOUNTS( issue_license_operation, (issuer)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_license_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( upgrade_account_cycles_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( submit_reserve_cycles_to_queue_operation, (issuer)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( submit_cycles_to_queue_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( submit_cycles_to_queue_by_license_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( record_submit_reserve_cycles_to_queue_operation, (cycle_issuer)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( record_submit_charter_license_cycles_operation, (license_issuer)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( record_distribute_dascoin_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_global_frequency_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( issue_free_cycles_operation, (authority)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( issue_cycles_to_license_operation, (authority)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_euro_limit_operation, (authority)(account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( create_upgrade_event_operation, (upgrade_creator) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_upgrade_event_operation, (upgrade_creator) )
+   GRAPHENE_IMPACTED_ACCOUNTS( delete_upgrade_event_operation, (upgrade_creator) )
+   GRAPHENE_IMPACTED_ACCOUNTS( purchase_cycle_asset_operation, (wallet_id) )
+   GRAPHENE_IMPACTED_ACCOUNTS( transfer_cycles_from_licence_to_wallet_operation, (vault_id)(wallet_id) )
+   GRAPHENE_IMPACTED_ACCOUNTS( set_starting_cycle_asset_amount_operation, (issuer) )
+
+   // Web assets and wire outs:
+   GRAPHENE_IMPACTED_ACCOUNTS( asset_create_issue_request_operation, (issuer)(receiver) )
+   GRAPHENE_IMPACTED_ACCOUNTS( asset_distribute_completed_request_operation, (issuer)(receiver) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_complete_operation, (wire_out_handler) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_reject_operation, (wire_out_handler) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_result_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_with_fee_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_with_fee_complete_operation, (wire_out_handler) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_with_fee_reject_operation, (wire_out_handler) )
+   GRAPHENE_IMPACTED_ACCOUNTS( wire_out_with_fee_result_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( transfer_vault_to_wallet_operation, (from_vault)(to_wallet) )
+   GRAPHENE_IMPACTED_ACCOUNTS( transfer_wallet_to_vault_operation, (from_wallet)(to_vault) )
+   GRAPHENE_IMPACTED_ACCOUNTS( reserve_asset_on_account_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( unreserve_asset_on_account_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( unreserve_completed_operation, (account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_external_btc_price_operation, (issuer) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_external_token_price_operation, (issuer) )
+
+   // DasPay:
+   GRAPHENE_IMPACTED_ACCOUNTS( set_daspay_transaction_ratio_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( create_payment_service_provider_operation,
+                               (authority)(payment_service_provider_account)(payment_service_provider_clearing_accounts) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_payment_service_provider_operation,
+                               (authority)(payment_service_provider_account)(payment_service_provider_clearing_accounts) )
+   GRAPHENE_IMPACTED_ACCOUNTS( delete_payment_service_provider_operation, (authority)(payment_service_provider_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( register_daspay_authority_operation, (issuer) )
+   GRAPHENE_IMPACTED_ACCOUNTS( unregister_daspay_authority_operation, (issuer) )
+   GRAPHENE_IMPACTED_ACCOUNTS( daspay_debit_account_operation, (payment_service_provider_account)(account)(clearing_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( daspay_credit_account_operation, (payment_service_provider_account)(account)(clearing_account) )
+   GRAPHENE_IMPACTED_ACCOUNTS( update_daspay_clearing_parameters_operation, (authority) )
+
+   // Das33:
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_project_create_operation, (authority)(owner) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_project_update_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_project_delete_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_pledge_asset_operation, (account_id) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_distribute_project_pledges_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_project_reject_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_distribute_pledge_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_pledge_reject_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_pledge_result_operation, (funders_account)(account_to_fund) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_set_use_external_btc_price_operation, (authority) )
+   GRAPHENE_IMPACTED_ACCOUNTS( das33_set_use_market_price_for_token_operation, (authority) )
+
+   // Operations which impact their required authorities only:
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( limit_order_create_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( call_order_update_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_create_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_update_bitasset_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_update_feed_producers_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_reserve_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_fund_fee_pool_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_settle_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_global_settle_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_publish_feed_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( proposal_update_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( proposal_delete_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( committee_member_update_global_parameters_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( vesting_balance_withdraw_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( worker_create_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( custom_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( assert_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( balance_claim_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_claim_fees_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( create_license_type_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( edit_license_type_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( account_upgrade_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( asset_deny_issue_request_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( update_queue_parameters_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( create_witness_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( update_witness_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( remove_witness_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( activate_witness_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( deactivate_witness_operation )
+   GRAPHENE_NO_IMPACTED_ACCOUNTS( remove_root_authority_operation )
+
+#undef GRAPHENE_NO_IMPACTED_ACCOUNTS
+#undef GRAPHENE_IMPACTED_ACCOUNTS
+#undef GRAPHENE_IMPACTED_ACCOUNT_FIELD
+
+   // Operations whose impacted accounts are nested inside their members:
+
+   template<>
+   struct impacted_account_fields<transfer_to_blind_operation>
+   {
+      template<typename Sink>
+      static void add( const transfer_to_blind_operation& op, Sink& sink )
+      {
+         sink.insert( op.from );
+         for( const auto& out : op.outputs )
+            add_impacted( out.owner, sink );
+      }
+   };
+
+   template<>
+   struct impacted_account_fields<blind_transfer_operation>
+   {
+      template<typename Sink>
+      static void add( const blind_transfer_operation& op, Sink& sink )
+      {
+         for( const auto& in : op.inputs )
+            add_impacted( in.owner, sink );
+         for( const auto& out : op.outputs )
+            add_impacted( out.owner, sink );
+      }
+   };
+
+   template<>
+   struct impacted_account_fields<transfer_from_blind_operation>
+   {
+      template<typename Sink>
+      static void add( const transfer_from_blind_operation& op, Sink& sink )
+      {
+         sink.insert( op.to );
+         for( const auto& in : op.inputs )
+            add_impacted( in.owner, sink );
+      }
+   };
+
+   template<>
+   struct impacted_account_fields<proposal_create_operation>
+   {
+      template<typename Sink>
+      static void add( const proposal_create_operation& op, Sink& sink )
+      {
+         flat_set<account_id_type> required;
+         vector<authority> other;
+         for( const auto& proposed_op : op.proposed_ops )
+            operation_get_required_authorities( proposed_op.op, required, required, other );
+         for( const auto& id : required )
+            sink.insert( id );
+         for( const auto& o : other )
+            add_impacted( o, sink );
+      }
+   };
+
+   template<typename Sink>
+   struct impacted_account_visitor
+   {
+      typedef void result_type;
+
+      Sink& _sink;
+      explicit impacted_account_visitor( Sink& sink ) : _sink( sink ) {}
+
+      template<typename Operation>
+      void operator()( const Operation& op )const
+      {
+         impacted_account_fields<Operation>::add( op, _sink );
+      }
+   };
+
+} // detail
+
+void operation_get_impacted_accounts( const operation& op, flat_set<account_id_type>& result )
+{
+   detail::impacted_account_visitor<flat_set<account_id_type>> vtor( result );
+   op.visit( vtor );
+}
+
+void operation_get_impacted_accounts( const operation& op, impacted_accounts_buffer& result )
+{
+   detail::impacted_account_visitor<impacted_accounts_buffer> vtor( result );
+   op.visit( vtor );
+}
+
+void transaction_get_impacted_accounts( const transaction& tx, flat_set<account_id_type>& result )
+{
+   for( const auto& op : tx.operations )
+      operation_get_impacted_accounts( op, result );
+}
+
+void transaction_get_impacted_accounts( const transaction& tx, impacted_accounts_buffer& result )
+{
+   for( const auto& op : tx.operations )
+      operation_get_impacted_accounts( op, result );
+}
+
+void operation_get_history_accounts( const operation& op, const operation_result& op_result,
+                                     impacted_accounts_buffer& result )
+{
+   flat_set<account_id_type> required;
+   vector<authority> other;
+   operation_get_required_authorities( op, required, required, other );
+   for( const auto& id : required )
+      result.insert( id );
+
+   if( op.which() == operation::tag< account_create_operation >::value )
+      result.insert( op_result.get<object_id_type>() );
+   else
+      operation_get_impacted_accounts( op, result );
+
+   for( const auto& a : other )
+      for( const auto& item : a.account_auths )
+         result.insert( item.first );
+}
+
+} } // graphene::chain
@@ -316,6 +316,8 @@ class database_access_layer {
     vector<optional<asset_object>> lookup_asset_symbols(const vector<string>& symbols_or_ids) const;
     bool check_issued_asset(const string& unique_id, const string& asset) const;
     bool check_issued_webeur(const string& unique_id) const;
+    vector<string> check_issued_assets(const vector<string>& unique_ids, const string& asset) const;
+    vector<string> check_issued_webeurs(const vector<string>& unique_ids) const;
 
     // Frequency:
     vector<frequency_history_record_object> get_frequency_history() const;
@@ -323,6 +325,8 @@ class database_access_layer {
 
   private:
     optional<asset_object> get_asset_symbol(const asset_index &index, const string& symbol_or_id) const;
+    bool is_issued(const string& unique_id, asset_id_type asset_id) const;
+    vector<string> filter_issued(const vector<string>& unique_ids, asset_id_type asset_id) const;
 
     template <typename IndexType>
     uint32_t size() const
@@ -26,7 +26,9 @@
 #include <graphene/chain/license_objects.hpp>
 #include <graphene/chain/upgrade_type.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/simple_index.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <unordered_map>
 
 namespace graphene { namespace chain {
    class database;
@@ -401,16 +403,36 @@ namespace graphene { namespace chain {
          }
    };
 
+   /**
+    *  @brief The fields of account_object which account_member_index depends on
+    */
+   struct account_member_fields
+   {
+      account_member_fields(){}
+      explicit account_member_fields( const account_object& a )
+         :owner(a.owner),active(a.active),memo_key(a.options.memo_key){}
+
+      bool matches( const account_object& a )const
+      {
+         return memo_key == a.options.memo_key && owner == a.owner && active == a.active;
+      }
+
+      authority       owner;
+      authority       active;
+      public_key_type memo_key;
+   };
+
    /**
     *  @brief This secondary index will allow a reverse lookup of all accounts that a particular key or account
     *  is an potential signing authority.
+    *
+    *  Only modifications of the owner and active authorities or of the memo key are reported to this index.
     */
-   class account_member_index : public secondary_index
+   class account_member_index : public filtered_secondary_index<account_object, account_member_fields>
    {
       public:
          virtual void object_inserted( const object& obj ) override;
          virtual void object_removed( const object& obj ) override;
-         virtual void about_to_modify( const object& before ) override;
          virtual void object_modified( const object& after  ) override;
 
 
@@ -422,13 +444,11 @@ namespace graphene { namespace chain {
 
 
       protected:
-         set<account_id_type>  get_account_members( const account_object& a )const;
-         set<public_key_type>  get_key_members( const account_object& a )const;
-         set<address>          get_address_members( const account_object& a )const;
-
-         set<account_id_type>  before_account_members;
-         set<public_key_type>  before_key_members;
-         set<address>          before_address_members;
+         set<account_id_type>  get_account_members( const authority& owner, const authority& active )const;
+         set<public_key_type>  get_key_members( const authority& owner, const authority& active,
+                                                const public_key_type& memo_key )const;
+         set<address>          get_address_members( const authority& owner, const authority& active,
+                                                    const public_key_type& memo_key )const;
    };
 
 
@@ -436,18 +456,70 @@ namespace graphene { namespace chain {
     *  @brief This secondary index will allow a reverse lookup of all accounts that have been referred by
     *  a particular account.
     */
-   class account_referrer_index : public secondary_index
+   class account_referrer_index : public filtered_secondary_index<account_object, no_watched_fields>
    {
       public:
          virtual void object_inserted( const object& obj ) override;
          virtual void object_removed( const object& obj ) override;
-         virtual void about_to_modify( const object& before ) override;
          virtual void object_modified( const object& after  ) override;
 
          /** maps the referrer to the set of accounts that they have referred */
          map< account_id_type, set<account_id_type> > referred_by;
    };
 
+   /**
+    *  @brief The fields of account_object which account_name_search_index depends on
+    */
+   struct account_name_fields
+   {
+      account_name_fields(){}
+      explicit account_name_fields( const account_object& a ):name(a.name){}
+
+      bool matches( const account_object& a )const { return name == a.name; }
+
+      string name;
+   };
+
+   /**
+    *  @brief This secondary index allows substring searches over account names.
+    *
+    *  Every distinct three character sequence (trigram) of a name maps to the sorted list of accounts whose
+    *  name contains it.  A query is answered by walking the shortest list of its trigrams and checking the
+    *  candidates against the stored names, so the cost depends on how common the rarest trigram is rather
+    *  than on the number of accounts.  Queries shorter than a trigram are not answered.
+    *
+    *  The index is not needed to validate blocks and is only registered by nodes which serve the search API,
+    *  see database::enable_account_name_search().
+    */
+   class account_name_search_index : public filtered_secondary_index<account_object, account_name_fields>
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         static const size_t min_query_length = 3;
+
+         /**
+          *  Find the accounts whose name contains query, in account id order, starting at start.
+          *  Queries shorter than min_query_length find nothing.
+          *  To continue a search, pass the account following the last one of the previous page as start.
+          */
+         vector<account_id_type> search( const string& query, account_id_type start, uint32_t limit )const;
+
+      private:
+         typedef uint32_t trigram_type;
+
+         static set<trigram_type> get_trigrams( const string& name );
+         void add_name( account_id_type id, const string& name );
+         void remove_name( account_id_type id, const string& name );
+
+         /** maps a trigram to the sorted accounts whose name contains it */
+         std::unordered_map< trigram_type, vector<account_id_type> > _accounts_by_trigram;
+         /** account names indexed by account instance, empty for removed accounts */
+         vector<string>                                              _names;
+   };
+
    struct by_account_asset;
    struct by_asset_balance;
    /**
@@ -566,3 +638,9 @@ FC_REFLECT_DERIVED( graphene::chain::account_cycle_balance_object, (graphene::db
                     (owner)
                     (balance)
                   )
+
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::account_object, graphene::chain::account_index )
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::account_statistics_object,
+                               graphene::db::simple_index<graphene::chain::account_statistics_object> )
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::account_balance_object, graphene::chain::account_balance_index )
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::account_cycle_balance_object, graphene::chain::account_cycle_balance_index )
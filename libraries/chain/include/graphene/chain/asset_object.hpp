@@ -26,6 +26,7 @@
 #include <boost/multi_index/composite_key.hpp>
 #include <graphene/db/flat_index.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/simple_index.hpp>
 
 /**
  * @defgroup prediction_market Prediction Market
@@ -349,3 +350,7 @@ FC_REFLECT_DERIVED( graphene::chain::issue_asset_request_object, (graphene::db::
                     (expiration)
                     (extensions)
                   )
+
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::asset_object, graphene::chain::asset_index )
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::asset_dynamic_data_object,
+                               graphene::db::simple_index<graphene::chain::asset_dynamic_data_object> )
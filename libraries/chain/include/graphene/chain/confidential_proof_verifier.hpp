@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/block.hpp>
+
+#include <fc/thread/future.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+
+namespace graphene { namespace chain {
+
+   /**
+    * @brief Verifies the commitments and range proofs of confidential operations off the chain thread
+    *
+    * Verifying the proofs of transfer_to_blind, transfer_from_blind and blind_transfer costs orders of magnitude
+    * more than any other validation.  When a block is about to be applied, precompute() hands the transactions
+    * with such operations to a small pool of worker threads; verify() then only waits for a result which is
+    * usually ready.  Results, including failures, are remembered by transaction digest, so a transaction which
+    * was verified when it was pushed as pending is not verified again when it arrives in a block.
+    *
+    * All methods are called from the chain thread.
+    */
+   class confidential_proof_verifier
+   {
+   public:
+      confidential_proof_verifier();
+      ~confidential_proof_verifier();
+
+      /** True if trx has operations with commitments or range proofs */
+      static bool has_proofs( const transaction& trx );
+      /** transaction::validate() without the verification of the proofs */
+      static void validate_without_proofs( const transaction& trx );
+
+      /** Start verifying the proofs of the transactions of the block which are not known yet */
+      void precompute( const signed_block& block );
+      /** Throw if the proofs of trx are invalid, waiting for a precomputed result or verifying them now */
+      void verify( const transaction& trx );
+
+   private:
+      static void verify_proofs( const transaction& trx );
+      void remember( const digest_type& digest, const fc::future<void>& result );
+
+      vector<std::unique_ptr<fc::thread>>      _threads;
+      size_t                                   _next_thread = 0;
+      std::map<digest_type, fc::future<void>>  _results;
+      std::deque<digest_type>                  _results_order;
+   };
+
+} } // graphene::chain
@@ -148,6 +148,11 @@
 
 #define GRAPHENE_IRREVERSIBLE_THRESHOLD                      (70 * GRAPHENE_1_PERCENT)
 
+/// Worker threads verifying the proofs of confidential transactions ahead of applying a block
+#define GRAPHENE_CONFIDENTIAL_PROOF_THREADS                  4
+/// Number of transactions whose confidential proof verification results are remembered
+#define GRAPHENE_CONFIDENTIAL_PROOF_CACHE_SIZE               10000
+
 /**
  *  Reserved Account IDs with special meaning
  */
@@ -333,6 +338,24 @@
 #define DASCOIN_DEFAULT_DELAYED_OPERATIONS_RESOLVER_INTERVAL_TIME_SECONDS (30)  ///< in seconds
 ///@}
 
+/**
+ * Maintenance task scheduler budgets (maximal number of items a task processes in one block):
+ */
+///@{
+#define DASCOIN_MAINTENANCE_TASK_RESET_SPENDING_LIMITS_BUDGET (2000)
+#define DASCOIN_MAINTENANCE_TASK_PERFORM_UPGRADES_BUDGET (500)
+#define DASCOIN_MAINTENANCE_TASK_RESOLVE_DELAYED_OPERATIONS_BUDGET (1000)
+///@}
+
+/**
+ * Time weighted average of the DSC:WEBEUR price used for spending limits, kept in hourly buckets over a week:
+ */
+///@{
+#define DASCOIN_TWAP_BUCKET_SECONDS (3600)
+#define DASCOIN_TWAP_BUCKET_COUNT (168)
+#define DASCOIN_TWAP_MAX_PRICE (static_cast<uint64_t>(1) << 40) ///< in DSC satoshis per one WebEUR
+///@}
+
 #define ORDER_BOOK_QUERY_PRECISION (static_cast<uint64_t>(1000000))
 #define ORDER_BOOK_GROUP_QUERY_PRECISION_DIFF (static_cast<uint64_t>(10000))
 
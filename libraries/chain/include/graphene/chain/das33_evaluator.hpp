@@ -150,5 +150,12 @@ namespace graphene { namespace chain {
   share_type precision_modifier(asset_object a, asset_object b);
   price get_price_in_web_eur(asset_id_type original_asset_id, const database& d);
 
+  /**
+   * Cheap checks of a pledge against current project, balance and per user totals, made before the signatures of
+   * a pledge-only transaction are verified. Every condition is also asserted by das33_pledge_asset_evaluator, so
+   * this only turns away pledges which evaluation would reject anyway.
+   */
+  void das33_pledge_precheck(const das33_pledge_asset_operation& op, const database& d);
+
 
 } }  // namespace graphene::chain
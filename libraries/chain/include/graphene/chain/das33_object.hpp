@@ -163,6 +163,47 @@ namespace graphene { namespace chain {
 
   using das33_pledge_holder_index = generic_index<das33_pledge_holder_object, das33_pledge_holder_multi_index_type>;
 
+  /**
+   *  @brief Running pledge totals per user, project and phase and per project and pledged asset
+   *
+   *  This is a secondary index on the das33_pledge_holder_index.  It holds the sums which the pledge evaluator and
+   *  the das33 API would otherwise rebuild by walking every pledge of a user or a project.  Totals only cover pledges
+   *  which still exist, so fully distributed and rejected pledges drop out of them just as they drop out of the
+   *  primary index.
+   *
+   *  @note only the *_remaining amounts of a pledge change after it is created, so modifications are not tracked
+   */
+  class das33_pledge_totals_index : public filtered_secondary_index<das33_pledge_holder_object, no_watched_fields>
+  {
+  public:
+    struct round_totals
+    {
+      share_type base_expected;
+      share_type bonus_expected;
+      uint32_t   pledge_count = 0;
+    };
+
+    struct asset_totals
+    {
+      share_type pledged;
+      uint32_t   pledge_count = 0;
+    };
+
+    /// Phases of a user's pledges, ordered by project and then phase number
+    typedef map<std::pair<das33_project_id_type, share_type>, round_totals> user_rounds_type;
+
+    virtual void object_inserted( const object& obj ) override;
+    virtual void object_removed( const object& obj ) override;
+
+    share_type base_expected_in_round( account_id_type user, das33_project_id_type project, share_type phase )const;
+    const user_rounds_type* find_user_rounds( account_id_type user )const;
+    const map<asset_id_type, asset_totals>* find_project_assets( das33_project_id_type project )const;
+
+  private:
+    map<account_id_type, user_rounds_type>                       _user_rounds;
+    map<das33_project_id_type, map<asset_id_type, asset_totals>> _project_assets;
+  };
+
   struct by_project_name;
   typedef multi_index_container<
       das33_project_object,
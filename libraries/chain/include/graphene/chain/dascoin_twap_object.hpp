@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/asset.hpp>
+#include <graphene/chain/protocol/types.hpp>
+#include <graphene/db/generic_index.hpp>
+#include <graphene/db/object.hpp>
+
+namespace graphene { namespace chain {
+
+  ///////////////////////////////
+  // OBJECTS:                  //
+  ///////////////////////////////
+  /**
+   * @class dascoin_twap_bucket_object
+   * @brief Integral of the DSC:WEBEUR price over one period of DASCOIN_TWAP_BUCKET_SECONDS.
+   * @ingroup object
+   *
+   * There is one bucket per slot of the circular buffer of @ref dascoin_twap_object, created when the slot is first
+   * used, so a fill only touches the bucket of its own period.
+   */
+  class dascoin_twap_bucket_object : public abstract_object<dascoin_twap_bucket_object>
+  {
+    public:
+      static const uint8_t space_id = implementation_ids;
+      static const uint8_t type_id  = impl_dascoin_twap_bucket_object_type;
+
+      uint32_t slot = 0;            ///< Period modulo DASCOIN_TWAP_BUCKET_COUNT
+      uint32_t period = 0;          ///< Start of the period divided by DASCOIN_TWAP_BUCKET_SECONDS
+      uint64_t weighted_sum = 0;    ///< Sum of price * seconds over the covered part of the period
+      uint32_t seconds = 0;         ///< Number of seconds of the period covered so far
+  };
+
+  /**
+   * @class dascoin_twap_object
+   * @brief Time weighted average of the DSC:WEBEUR price over the last DASCOIN_TWAP_BUCKET_COUNT periods.
+   * @ingroup object
+   *
+   * Singleton created by the first DSC:WEBEUR fill or spending limit reset after HARDFORK_DASCOIN_TWAP_TIME. Prices
+   * are kept as the amount of DSC satoshis paid for one WebEUR. The price in effect since last_update is integrated
+   * into the bucket of each period (see database::accrue_dascoin_twap), and the sums over the whole window are
+   * maintained along, so both recording a fill and reading the average take constant time. All arithmetic is on
+   * integers, every node computes the same average.
+   */
+  class dascoin_twap_object : public abstract_object<dascoin_twap_object>
+  {
+    public:
+      static const uint8_t space_id = implementation_ids;
+      static const uint8_t type_id  = impl_dascoin_twap_object_type;
+
+      uint64_t last_price = 0;               ///< Price in effect since last_update
+      time_point_sec last_update;
+      uint64_t window_weighted_sum = 0;      ///< Sum of weighted_sum over all buckets
+      uint64_t window_seconds = 0;           ///< Sum of seconds over all buckets
+
+      extensions_type extensions;
+
+      /** The average as of the last accrual, last_price if no time has been covered yet */
+      uint64_t average() const;
+
+      /** DSC satoshis per one WebEUR, clamped to DASCOIN_TWAP_MAX_PRICE; 0 for an empty fill */
+      static uint64_t to_twap_price(const asset& dascoin_amount, const asset& web_amount);
+      static price from_twap_price(uint64_t twap_price, asset_id_type dascoin_id, asset_id_type web_id);
+  };
+
+  ///////////////////////////////
+  // MULTI INDEX CONTAINERS:   //
+  ///////////////////////////////
+
+  typedef multi_index_container<
+    dascoin_twap_object,
+    indexed_by<
+      ordered_unique< tag<by_id>,
+        member<object, object_id_type, &object::id>
+      >
+    >
+  > dascoin_twap_multi_index_type;
+
+  typedef generic_index<dascoin_twap_object, dascoin_twap_multi_index_type> dascoin_twap_index;
+
+  struct by_slot;
+  typedef multi_index_container<
+    dascoin_twap_bucket_object,
+    indexed_by<
+      ordered_unique< tag<by_id>,
+        member<object, object_id_type, &object::id>
+      >,
+      ordered_unique< tag<by_slot>,
+        member<dascoin_twap_bucket_object, uint32_t, &dascoin_twap_bucket_object::slot>
+      >
+    >
+  > dascoin_twap_bucket_multi_index_type;
+
+  typedef generic_index<dascoin_twap_bucket_object, dascoin_twap_bucket_multi_index_type> dascoin_twap_bucket_index;
+
+} }  // namespace graphene::chain
+
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::dascoin_twap_object, graphene::chain::dascoin_twap_index )
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::dascoin_twap_bucket_object, graphene::chain::dascoin_twap_bucket_index )
+
+FC_REFLECT_DERIVED( graphene::chain::dascoin_twap_bucket_object, (graphene::db::object),
+                    (slot)
+                    (period)
+                    (weighted_sum)
+                    (seconds)
+                  )
+
+FC_REFLECT_DERIVED( graphene::chain::dascoin_twap_object, (graphene::db::object),
+                    (last_price)
+                    (last_update)
+                    (window_weighted_sum)
+                    (window_seconds)
+                    (extensions)
+                  )
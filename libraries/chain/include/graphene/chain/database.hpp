@@ -28,9 +28,12 @@
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/confidential_proof_verifier.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
 #include <graphene/chain/license_objects.hpp>
+#include <graphene/chain/maintenance_task_object.hpp>
+#include <graphene/chain/market_object.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -163,6 +166,10 @@ namespace graphene { namespace chain {
          void pop_block();
          void clear_pending();
 
+         const block_production_stats& get_block_production_stats()const { return _block_production_stats; }
+         /** Records how long after the start of its slot a block generated by this node was broadcast */
+         void record_block_broadcast_latency( fc::microseconds latency );
+
          /**
           *  This method is used to track appied operations during the evaluation of a block, these
           *  operations should include any operation actually included in a transaction as well
@@ -276,6 +283,32 @@ namespace graphene { namespace chain {
          const node_property_object&            get_node_properties()const;
          const fee_schedule&                    current_fee_schedule()const;
 
+         /**
+          *  Market prices are kept in one last_price_object/external_price_object per market and looked up
+          *  through a hash registry, so reading a price is a constant time lookup and recording one modifies
+          *  only the small price object.  The getters below return null when the market has no price yet.
+          */
+         const last_price_object*               find_last_price( asset_id_type base, asset_id_type quote )const;
+         const external_price_object*           find_external_price( asset_id_type base, asset_id_type quote )const;
+         void                                   set_last_price( const market_key& market, const price& p );
+         void                                   set_external_price( const market_key& market, const price& p );
+
+         /** Last trade price on the DSC:WEBEUR market, the genesis price if there has been no trade yet */
+         price                                  get_last_dascoin_price()const;
+         /** Last trade price on the BTC:WEBEUR market, the genesis price if there has been no trade yet */
+         price                                  get_last_btc_price()const;
+         /** Last BTC:WEBEUR price set by the external oracle, kept on the dynamic global properties */
+         price                                  get_external_btc_price()const;
+
+         /**
+          *  Maintain an account_name_search_index for substring searches over account names.  It is not needed
+          *  to validate blocks, so only nodes serving the search API enable it; accounts which already exist are
+          *  indexed when it is enabled.
+          */
+         void                                   enable_account_name_search();
+         /** The account name search index, null unless enable_account_name_search() has been called */
+         const account_name_search_index*       get_account_name_search()const { return _account_name_search; }
+
          time_point_sec   head_block_time()const;
          uint32_t         head_block_num()const;
          block_id_type    head_block_id()const;
@@ -609,6 +642,33 @@ namespace graphene { namespace chain {
          void notify_changed_objects();
 
       private:
+         /**
+          *  Candidate block kept up to date while transactions are pushed to the pending state. It covers the
+          *  longest prefix of _pending_tx that fits into a block, together with the merkle digests of those
+          *  transactions. As long as the head block has not changed, generate_block() can take the prefix as
+          *  it is instead of re-applying every pending transaction.
+          */
+         struct block_template
+         {
+            bool                 valid = false;
+            bool                 full = false;
+            block_id_type        previous;
+            /** union of the skip flags the transactions were applied with */
+            uint32_t             skip = 0;
+            size_t               block_size = 0;
+            vector<digest_type>  merkle_digests;
+         };
+
+         signed_block finalize_generated_block( signed_block& pending_block,
+                                                const fc::ecc::private_key& block_signing_private_key,
+                                                uint32_t skip );
+         void update_block_production_stats( fc::time_point generation_start, uint64_t deferred_tx_count );
+         void reset_block_template();
+         void extend_block_template( const processed_transaction& ptx );
+         bool block_template_usable( uint32_t skip )const;
+
+         block_template                         _block_template;
+         block_production_stats                 _block_production_stats;
          optional<undo_database::session>       _pending_tx_session;
          vector< unique_ptr<op_evaluator> >     _operation_evaluators;
 
@@ -650,7 +710,32 @@ namespace graphene { namespace chain {
          void reset_spending_limits();
          void daspay_clearing_start();
          void resolve_delayed_operations();
+
+         /**
+          * Queue a run of a maintenance task for the given object (see @ref maintenance_task_object).
+          * A run which is already waiting for the same object is not queued again.
+          */
+         void trigger_maintenance_task(maintenance_task_kind kind, object_id_type subject);
+         /// Perform one budgeted step of every running maintenance task.
+         void run_maintenance_tasks();
+
+         /**
+          * Feed a DSC:WEBEUR trade into the time weighted average price (see @ref dascoin_twap_object).
+          */
+         void record_dascoin_twap_price(const asset& dascoin_amount, const asset& web_amount);
+         /// Bring the time weighted average price up to the head block time and return it.
+         price update_dascoin_twap_price();
+         /// Integrate the price in effect since the last update up to now, one bucket object per period covered.
+         void accrue_dascoin_twap(time_point_sec now);
 private:
+         const dascoin_twap_object& get_dascoin_twap();
+         const dascoin_twap_bucket_object& get_dascoin_twap_bucket(uint32_t slot);
+         /// The price spending limits are reset with: the time weighted average after HARDFORK_DASCOIN_TWAP_TIME.
+         price get_spending_limit_price();
+         const maintenance_task_object& get_maintenance_task(maintenance_task_kind kind);
+         bool run_maintenance_task_step(const maintenance_task_object& task);
+         template<typename IndexType, typename Tag, typename Lambda>
+         bool process_maintenance_task_items(const maintenance_task_object& task, Lambda process);
 
          ///Steps performed only at maintenance intervals
          ///@{
@@ -687,6 +772,8 @@ public:
 
 private:
          vector< processed_transaction >        _pending_tx;
+         /** time it took to apply each transaction of _pending_tx when it was pushed */
+         vector< fc::microseconds >             _pending_tx_apply_time;
          fork_database                          _fork_db;
 
          /**
@@ -729,6 +816,12 @@ private:
 
          node_property_object              _node_property_object;
 
+         confidential_proof_verifier       _confidential_proofs;
+
+         const last_price_registry*        _last_prices = nullptr;
+         const external_price_registry*    _external_prices = nullptr;
+         const account_name_search_index*  _account_name_search = nullptr;
+
          transaction_evaluation_state      _genesis_eval_state;
 
    };
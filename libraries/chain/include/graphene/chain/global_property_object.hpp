@@ -29,6 +29,7 @@
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/db/object.hpp>
+#include <graphene/db/simple_index.hpp>
 
 namespace graphene { namespace chain {
 
@@ -184,22 +185,26 @@ namespace graphene { namespace chain {
          time_point_sec next_spend_limit_reset = fc::time_point_sec();
 
          /**
-          * Last dascoin trade price on the DSC:WEBEUR market.
+          * Dascoin price on the DSC:WEBEUR market set at genesis.  Trades are recorded in the market's
+          * last_price_object, read the current price with database::get_last_dascoin_price().
           */
          price last_dascoin_price;
 
          /**
-          * Last bitcoin trade price on the BTC:WEBEUR market.
+          * Bitcoin price on the BTC:WEBEUR market set at genesis.  Trades are recorded in the market's
+          * last_price_object, read the current price with database::get_last_btc_price().
           */
          price last_btc_price;
 
          /**
-          * Last bitcoin price set by external oracle
+          * Last bitcoin price set by external oracle.  It stays here rather than in the BTC:WEBEUR
+          * external_price_object, which update_external_token_price_operation may also write.
           */
          price external_btc_price;
 
          /**
-          * Last daily dascoin trade price on the DSC:WEBEUR market.
+          * DSC:WEBEUR price sampled at the last spending limit reset. After HARDFORK_DASCOIN_TWAP_TIME it is the time
+          * weighted average price (see @ref dascoin_twap_object) rather than the last trade price.
           */
          price last_daily_dascoin_price;
 
@@ -289,3 +294,8 @@ FC_REFLECT_DERIVED( graphene::chain::global_property_object, (graphene::db::obje
                     (delayed_operations_resolver_interval_time_seconds)
                     (das33_parameters)
                   )
+
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::global_property_object,
+                               graphene::db::simple_index<graphene::chain::global_property_object> )
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::dynamic_global_property_object,
+                               graphene::db::simple_index<graphene::chain::dynamic_global_property_object> )
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <fc/container/flat.hpp>
+#include <graphene/chain/protocol/operations.hpp>
+#include <graphene/chain/protocol/transaction.hpp>
+#include <graphene/chain/protocol/types.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace graphene { namespace chain {
+
+   /**
+    * @brief Duplicate free set of account ids which lives on the stack for the handful of accounts an operation
+    * usually touches
+    *
+    * Up to Capacity accounts are kept inline; only operations which name more (proposals, blind transfers, payment
+    * service providers with many clearing accounts) spill over to the heap.  Accounts are kept in ascending order,
+    * like flat_set, since callers such as the account history plugin create objects in iteration order.
+    */
+   class impacted_accounts_buffer
+   {
+   public:
+      static constexpr size_t Capacity = 8;
+
+      void insert( account_id_type id )
+      {
+         if( _spill.empty() )
+         {
+            account_id_type* pos = std::lower_bound( _inline.data(), _inline.data() + _size, id );
+            if( pos != _inline.data() + _size && *pos == id )
+               return;
+            if( _size < Capacity )
+            {
+               std::copy_backward( pos, _inline.data() + _size, _inline.data() + _size + 1 );
+               *pos = id;
+               ++_size;
+               return;
+            }
+            _spill.assign( _inline.begin(), _inline.end() );
+         }
+         auto pos = std::lower_bound( _spill.begin(), _spill.end(), id );
+         if( pos == _spill.end() || *pos != id )
+            _spill.insert( pos, id );
+      }
+
+      const account_id_type* begin()const { return _spill.empty() ? _inline.data() : _spill.data(); }
+      const account_id_type* end()const { return _spill.empty() ? _inline.data() + _size : _spill.data() + _spill.size(); }
+      size_t size()const { return _spill.empty() ? _size : _spill.size(); }
+      bool empty()const { return size() == 0; }
+      bool spilled()const { return !_spill.empty(); }
+
+      void clear()
+      {
+         _size = 0;
+         _spill.clear();
+      }
+
+   private:
+      std::array<account_id_type, Capacity> _inline;
+      size_t                                _size = 0;
+      vector<account_id_type>               _spill;
+   };
+
+   /**
+    * Accounts an operation affects beyond the ones whose authority it requires.  The fields consulted for each
+    * operation type are listed in impacted_accounts.cpp.
+    */
+   void operation_get_impacted_accounts( const operation& op, flat_set<account_id_type>& result );
+   void operation_get_impacted_accounts( const operation& op, impacted_accounts_buffer& result );
+
+   void transaction_get_impacted_accounts( const transaction& tx, flat_set<account_id_type>& result );
+   void transaction_get_impacted_accounts( const transaction& tx, impacted_accounts_buffer& result );
+
+   /**
+    * Accounts whose history an applied operation belongs to: the ones whose authority it requires, the ones it
+    * impacts and, for account_create_operation, the account it created, taken from its result.
+    */
+   void operation_get_history_accounts( const operation& op, const operation_result& op_result,
+                                        impacted_accounts_buffer& result );
+
+} } // graphene::chain
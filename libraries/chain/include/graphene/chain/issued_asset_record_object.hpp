@@ -29,6 +29,7 @@
 #include <graphene/db/object.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 
 namespace graphene {
 namespace chain {
@@ -77,12 +78,17 @@ namespace chain {
         tag<by_id>,
         member<object, object_id_type, &object::id> 
       >,
-      ordered_unique<
+      // Only ever searched for exact (unique_id, asset) pairs, on every issue and every back office check:
+      hashed_unique<
         tag<by_unique_id_asset>,
         composite_key<
           issued_asset_record_object,
           member<issued_asset_record_object, string, &issued_asset_record_object::unique_id>,
           member<issued_asset_record_object, asset_id_type, &issued_asset_record_object::asset_type>
+        >,
+        composite_key_hash<
+          boost::hash<string>,
+          boost::hash<asset_id_type>
         >
       >,
       ordered_non_unique< 
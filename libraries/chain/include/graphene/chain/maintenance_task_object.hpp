@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/asset.hpp>
+#include <graphene/chain/protocol/types.hpp>
+#include <graphene/db/generic_index.hpp>
+#include <graphene/db/object.hpp>
+
+namespace graphene { namespace chain {
+
+  /**
+   * Kinds of chain maintenance work which are spread over consecutive blocks by the maintenance task scheduler.
+   * Within a block the scheduler runs the tasks in the order of this enumeration.
+   */
+  enum class maintenance_task_kind : uint8_t
+  {
+    reset_spending_limits,
+    perform_upgrades,
+    resolve_delayed_operations,
+    MAINTENANCE_TASK_KIND_COUNT
+  };
+
+  ///////////////////////////////
+  // OBJECTS:                  //
+  ///////////////////////////////
+  /**
+   * @class maintenance_task_object
+   * @brief Persistent state of a chain maintenance task.
+   * @ingroup object
+   *
+   * A task is triggered by queueing the id of the object it has to be run for (the upgrade event for upgrades, the
+   * dynamic global properties for periodic tasks). The front of the queue is processed in runs of at most
+   * budget_per_block items per block, walking the task's index from the cursor: in id order, except for upgrades
+   * which walk the accounts by name like they did before the scheduler, so that the cycles reach the reward queue
+   * in the same order. Since the cursor is a part of the chain state, every node spreads the work over exactly the
+   * same blocks. An upgrade only covers the accounts which existed when its run started, accounts registered during
+   * the run are skipped even if their names are still ahead of the cursor.
+   */
+  class maintenance_task_object : public abstract_object<maintenance_task_object>
+  {
+    public:
+      static const uint8_t space_id = implementation_ids;
+      static const uint8_t type_id  = impl_maintenance_task_object_type;
+
+      maintenance_task_kind kind;
+      uint32_t budget_per_block = 0;   ///< Maximal number of items processed in one block, 0 for no limit
+      vector<object_id_type> queue;    ///< Pending runs, the front one is in progress
+      object_id_type cursor;           ///< Id of the next item to be processed by the current run
+      string name_cursor;              ///< Name of the next account to be processed, for runs walking accounts by name
+      price run_price;                 ///< The spending limit price, sampled when a run of the limit reset starts
+      object_id_type first_new_id;     ///< First account id handed out after a run of the upgrades started
+      uint32_t started_at_block = 0;   ///< Block in which the current run has started
+      uint64_t processed = 0;          ///< Number of items processed by the current run
+
+      extensions_type extensions;
+
+      maintenance_task_object() = default;
+      explicit maintenance_task_object(maintenance_task_kind kind, uint32_t budget_per_block)
+      : kind(kind),
+        budget_per_block(budget_per_block) {}
+
+      bool running() const { return !queue.empty(); }
+  };
+
+  ///////////////////////////////
+  // MULTI INDEX CONTAINERS:   //
+  ///////////////////////////////
+
+  struct by_kind;
+  typedef multi_index_container<
+    maintenance_task_object,
+    indexed_by<
+      ordered_unique< tag<by_id>,
+        member<object, object_id_type, &object::id>
+      >,
+      ordered_unique< tag<by_kind>,
+        member<maintenance_task_object, maintenance_task_kind, &maintenance_task_object::kind>
+      >
+    >
+  > maintenance_task_multi_index_type;
+
+  typedef generic_index<maintenance_task_object, maintenance_task_multi_index_type> maintenance_task_index;
+
+} }  // namespace graphene::chain
+
+GRAPHENE_DEFINE_PRIMARY_INDEX( graphene::chain::maintenance_task_object, graphene::chain::maintenance_task_index )
+
+FC_REFLECT_ENUM( graphene::chain::maintenance_task_kind,
+                 (reset_spending_limits)
+                 (perform_upgrades)
+                 (resolve_delayed_operations)
+                 (MAINTENANCE_TASK_KIND_COUNT)
+               )
+
+FC_REFLECT_DERIVED( graphene::chain::maintenance_task_object, (graphene::db::object),
+                    (kind)
+                    (budget_per_block)
+                    (queue)
+                    (cursor)
+                    (name_cursor)
+                    (run_price)
+                    (first_new_id)
+                    (started_at_block)
+                    (processed)
+                    (extensions)
+                  )
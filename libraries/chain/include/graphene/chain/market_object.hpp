@@ -30,6 +30,8 @@
 
 #include <boost/multi_index/composite_key.hpp>
 
+#include <unordered_map>
+
 namespace graphene { namespace chain {
 
 using namespace graphene::db;
@@ -157,6 +159,50 @@ typedef multi_index_container<
 
 typedef generic_index<external_price_object, external_price_multi_index_type> external_price_index;
 
+struct market_key_hash
+{
+   size_t operator()( const market_key& m )const
+   {
+      return std::hash<uint64_t>()( (uint64_t(m.base.instance.value) << 32) ^ m.quote.instance.value );
+   }
+};
+
+/**
+ *  @brief Constant time lookup of the price objects of a market by its asset pair
+ *
+ *  Attached to last_price_index and external_price_index.  The market of a price object never changes, so
+ *  modifications are not reported to it.  Prices should be read through the database (find_last_price,
+ *  find_external_price, get_last_dascoin_price, ...), which keeps a pointer to both registries.
+ */
+template<typename PriceObject>
+class market_price_registry : public filtered_secondary_index<PriceObject, no_watched_fields>
+{
+   public:
+      virtual void object_inserted( const object& obj ) override
+      {
+         const auto& p = static_cast<const PriceObject&>( obj );
+         _prices[p.market] = &p;
+      }
+
+      virtual void object_removed( const object& obj ) override
+      {
+         _prices.erase( static_cast<const PriceObject&>( obj ).market );
+      }
+
+      /** @return the price object of the market, or nullptr if there is none */
+      const PriceObject* find( const market_key& market )const
+      {
+         auto itr = _prices.find( market );
+         return itr == _prices.end() ? nullptr : itr->second;
+      }
+
+   private:
+      std::unordered_map<market_key, const PriceObject*, market_key_hash> _prices;
+};
+
+typedef market_price_registry<last_price_object>     last_price_registry;
+typedef market_price_registry<external_price_object> external_price_registry;
+
 /**
  * @class call_order_object
  * @brief tracks debt and call price information
@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <graphene/db/object.hpp>
+#include <fc/time.hpp>
 
 namespace graphene { namespace chain {
 
@@ -44,5 +45,38 @@ namespace graphene { namespace chain {
 
          uint32_t skip_flags = 0;
          std::map< block_id_type, std::vector< fc::variant_object > > debug_updates;
+
+         /**
+          *  Wall clock time generate_block() may spend applying pending transactions. Transactions
+          *  which would not fit into the remaining time are deferred to a later block. Zero disables
+          *  the limit.
+          */
+         fc::microseconds block_production_time_budget;
+   };
+
+   /**
+    * @brief Statistics about blocks generated by this node
+    */
+   struct block_production_stats
+   {
+      uint64_t         blocks_generated = 0;
+      /** blocks for which at least one transaction was deferred because of the time budget */
+      uint64_t         blocks_over_budget = 0;
+      uint64_t         transactions_deferred = 0;
+      fc::microseconds last_generation_time;
+      fc::microseconds max_generation_time;
+      /** time from the start of a generated block's slot until it was broadcast, negative if it went out early */
+      fc::microseconds last_broadcast_latency;
+      fc::microseconds max_broadcast_latency;
    };
 } } // graphene::chain
+
+FC_REFLECT( graphene::chain::block_production_stats,
+            (blocks_generated)
+            (blocks_over_budget)
+            (transactions_deferred)
+            (last_generation_time)
+            (max_generation_time)
+            (last_broadcast_latency)
+            (max_broadcast_latency)
+          )
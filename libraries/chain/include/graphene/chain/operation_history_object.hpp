@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #pragma once
+#include <graphene/chain/protocol/compact_operation.hpp>
 #include <graphene/chain/protocol/operations.hpp>
 #include <graphene/db/object.hpp>
 #include <boost/multi_index/composite_key.hpp>
@@ -52,7 +53,8 @@ namespace graphene { namespace chain {
          operation_history_object( const operation& o ):op(o){}
          operation_history_object(){}
 
-         operation         op;
+         /** kept compact, since full history nodes hold one of these for every operation ever applied */
+         compact_operation op;
          operation_result  result;
          /** the block that caused this operation */
          uint32_t          block_num = 0;
@@ -65,13 +65,11 @@ class proposal_object : public abstract_object<proposal_object>
  *
  *  @note the set of required approvals is constant
  */
-class required_approval_index : public secondary_index
+class required_approval_index : public filtered_secondary_index<proposal_object, no_watched_fields>
 {
    public:
       virtual void object_inserted( const object& obj ) override;
       virtual void object_removed( const object& obj ) override;
-      virtual void about_to_modify( const object& before ) override{};
-      virtual void object_modified( const object& after  ) override{};
 
       void remove( account_id_type a, proposal_id_type p );
 
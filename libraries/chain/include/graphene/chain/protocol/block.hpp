@@ -52,6 +52,8 @@ namespace graphene { namespace chain {
    struct signed_block : public signed_block_header
    {
       checksum_type calculate_merkle_root()const;
+      /** computes the merkle root from the merkle_digest() of every transaction, in block order */
+      static checksum_type calculate_merkle_root( vector<digest_type> ids );
       vector<processed_transaction> transactions;
    };
 
@@ -0,0 +1,200 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/operations.hpp>
+
+#include <memory>
+#include <type_traits>
+
+namespace graphene { namespace chain {
+
+   namespace detail {
+      template<typename T, typename... Ts>
+      struct type_in_list : std::false_type {};
+      template<typename T, typename... Ts>
+      struct type_in_list<T, T, Ts...> : std::true_type {};
+      template<typename T, typename U, typename... Ts>
+      struct type_in_list<T, U, Ts...> : type_in_list<T, Ts...> {};
+
+      template<typename T, typename Variant>
+      struct is_variant_member;
+      template<typename T, typename... Ts>
+      struct is_variant_member<T, fc::static_variant<Ts...>> : type_in_list<T, Ts...> {};
+   }
+
+   /**
+    * @brief An operation which keeps only the frequent operation types in place
+    *
+    * An operation is as large as its largest type, so every operation kept in memory pays for the rare account,
+    * asset and governance operations.  compact_operation stores the common DasCoin operations in a variant sized
+    * for them only (inline_operation); any other type is stored out of line in an immutable operation shared by
+    * the copies of the compact_operation.
+    *
+    * It converts from and to operation, exposes which(), visit() and get<T>() like the operation it holds, and is
+    * serialized exactly like that operation.  programs/size_checker reports the sizes of both representations.
+    */
+   class compact_operation
+   {
+   public:
+      typedef fc::static_variant<
+            transfer_operation,
+            limit_order_create_operation,
+            limit_order_cancel_operation,
+            fill_order_operation,
+            transfer_vault_to_wallet_operation,
+            transfer_wallet_to_vault_operation,
+            submit_cycles_to_queue_operation,
+            record_submit_reserve_cycles_to_queue_operation,
+            record_submit_charter_license_cycles_operation,
+            record_distribute_dascoin_operation,
+            reserve_asset_on_account_operation,
+            unreserve_asset_on_account_operation,
+            daspay_debit_account_operation,
+            daspay_credit_account_operation
+         > inline_operation;
+
+      /** True for the operation types kept in place */
+      template<typename T>
+      struct is_inline : detail::is_variant_member<T, inline_operation> {};
+
+      compact_operation() : compact_operation( operation() ) {}
+      compact_operation( const operation& op ) { assign( op ); }
+
+      compact_operation& operator=( const operation& op ) { assign( op ); return *this; }
+
+      /** The tag of the held type in operation */
+      int which()const { return _which; }
+      bool is_inline_stored()const { return !_outline; }
+
+      operation to_operation()const
+      {
+         if( _outline )
+            return *_outline;
+         return _inline.visit( to_operation_visitor() );
+      }
+
+      template<typename T>
+      const T& get()const
+      {
+         return get( typename is_inline<T>::type(), (const T*)nullptr );
+      }
+
+      template<typename Visitor>
+      typename Visitor::result_type visit( Visitor& v )const
+      {
+         return _outline ? _outline->visit( v ) : _inline.visit( v );
+      }
+
+      template<typename Visitor>
+      typename Visitor::result_type visit( const Visitor& v )const
+      {
+         return _outline ? _outline->visit( v ) : _inline.visit( v );
+      }
+
+   private:
+      struct to_operation_visitor
+      {
+         typedef operation result_type;
+         template<typename T>
+         operation operator()( const T& op )const { return operation( op ); }
+      };
+
+      struct assign_visitor
+      {
+         typedef void result_type;
+         compact_operation& self;
+         const operation& op;
+
+         template<typename T>
+         void operator()( const T& o )const { self.store( o, op, typename is_inline<T>::type() ); }
+      };
+
+      void assign( const operation& op )
+      {
+         _which = op.which();
+         op.visit( assign_visitor{ *this, op } );
+      }
+
+      template<typename T>
+      void store( const T& o, const operation&, std::true_type )
+      {
+         _inline = inline_operation( o );
+         _outline.reset();
+      }
+
+      template<typename T>
+      void store( const T&, const operation& op, std::false_type )
+      {
+         _inline = inline_operation();
+         _outline = std::make_shared<const operation>( op );
+      }
+
+      template<typename T>
+      const T& get( std::true_type, const T* )const { return _inline.get<T>(); }
+      template<typename T>
+      const T& get( std::false_type, const T* )const
+      {
+         FC_ASSERT( _outline, "Operation is not stored out of line" );
+         return _outline->get<T>();
+      }
+
+      int                               _which = 0;
+      inline_operation                  _inline;
+      std::shared_ptr<const operation>  _outline;
+   };
+
+} } // graphene::chain
+
+namespace fc {
+   inline void to_variant( const graphene::chain::compact_operation& op, fc::variant& var )
+   {
+      to_variant( op.to_operation(), var );
+   }
+
+   inline void from_variant( const fc::variant& var, graphene::chain::compact_operation& op )
+   {
+      graphene::chain::operation o;
+      from_variant( var, o );
+      op = o;
+   }
+
+   namespace raw {
+      template<typename Stream>
+      inline void pack( Stream& s, const graphene::chain::compact_operation& op )
+      {
+         fc::raw::pack( s, op.to_operation() );
+      }
+
+      template<typename Stream>
+      inline void unpack( Stream& s, graphene::chain::compact_operation& op )
+      {
+         graphene::chain::operation o;
+         fc::raw::unpack( s, o );
+         op = o;
+      }
+   }
+}
+
+FC_REFLECT_TYPENAME( graphene::chain::compact_operation )
@@ -161,6 +161,10 @@ struct transfer_to_blind_operation : public base_operation
 
    account_id_type fee_payer()const { return from; }
    void            validate()const;
+   /// validate() without validate_proofs()
+   void            validate_structure()const;
+   /// Verify the commitments and range proofs, the expensive part of validate()
+   void            validate_proofs()const;
    share_type      calculate_fee(const fee_parameters_type& )const;
 };
 
@@ -182,6 +186,10 @@ struct transfer_from_blind_operation : public base_operation
 
    account_id_type fee_payer()const { return GRAPHENE_TEMP_ACCOUNT; }
    void            validate()const;
+   /// validate() without validate_proofs()
+   void            validate_structure()const;
+   /// Verify the commitments and range proofs, the expensive part of validate()
+   void            validate_proofs()const;
 
    void            get_required_authorities( vector<authority>& a )const
    {
@@ -247,6 +255,10 @@ struct blind_transfer_operation : public base_operation
    /** graphene TEMP account */
    account_id_type fee_payer()const;
    void            validate()const;
+   /// validate() without validate_proofs()
+   void            validate_structure()const;
+   /// Verify the commitments and range proofs, the expensive part of validate()
+   void            validate_proofs()const;
    share_type      calculate_fee( const fee_parameters_type& k )const;
 
    void            get_required_authorities( vector<authority>& a )const
@@ -290,7 +290,10 @@ namespace graphene { namespace chain {
       impl_payment_service_provider_object_type,
       impl_das33_project_object_type,
       impl_das33_pledge_holder_object_type,
-      impl_delayed_operation_object_type
+      impl_delayed_operation_object_type,
+      impl_maintenance_task_object_type,
+      impl_dascoin_twap_object_type,
+      impl_dascoin_twap_bucket_object_type
    };
 
    //typedef fc::unsigned_int            object_id_type;
@@ -361,6 +364,9 @@ namespace graphene { namespace chain {
    class das33_project_object;
    class das33_pledge_holder_object;
    class delayed_operation_object;
+   class maintenance_task_object;
+   class dascoin_twap_object;
+   class dascoin_twap_bucket_object;
 
    typedef object_id< implementation_ids, impl_global_property_object_type,  global_property_object>                    global_property_id_type;
    typedef object_id< implementation_ids, impl_dynamic_global_property_object_type,  dynamic_global_property_object>    dynamic_global_property_id_type;
@@ -438,6 +444,18 @@ namespace graphene { namespace chain {
          implementation_ids, impl_das33_pledge_holder_object_type, das33_pledge_holder_object
       > das33_pledge_holder_id_type;
 
+   typedef object_id<
+         implementation_ids, impl_maintenance_task_object_type, maintenance_task_object
+      > maintenance_task_id_type;
+
+   typedef object_id<
+         implementation_ids, impl_dascoin_twap_object_type, dascoin_twap_object
+      > dascoin_twap_id_type;
+
+   typedef object_id<
+         implementation_ids, impl_dascoin_twap_bucket_object_type, dascoin_twap_bucket_object
+      > dascoin_twap_bucket_id_type;
+
    typedef fc::array<char, GRAPHENE_MAX_ASSET_SYMBOL_LENGTH>    symbol_type;
    typedef fc::ripemd160                                        block_id_type;
    typedef fc::ripemd160                                        checksum_type;
@@ -668,6 +686,9 @@ FC_REFLECT_ENUM( graphene::chain::impl_object_type,
                  (impl_das33_project_object_type)
                  (impl_das33_pledge_holder_object_type)
                  (impl_delayed_operation_object_type)
+                 (impl_maintenance_task_object_type)
+                 (impl_dascoin_twap_object_type)
+                 (impl_dascoin_twap_bucket_object_type)
                )
 
 FC_REFLECT_TYPENAME( graphene::chain::share_type )
@@ -716,6 +737,9 @@ FC_REFLECT_TYPENAME( graphene::chain::daspay_authority_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::das33_project_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::das33_pledge_holder_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::delayed_operation_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::maintenance_task_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::dascoin_twap_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::dascoin_twap_bucket_id_type )
 
 FC_REFLECT( graphene::chain::void_t, )
 
@@ -39,8 +39,35 @@ namespace graphene { namespace db {
    {
       public:
          typedef T object_type;
+         /// objects move whenever the vector grows, so they are not in the object_table
+         static const bool stable_addresses = false;
 
          virtual const object&  create( const std::function<void(object&)>& constructor ) override
+         {
+            return create_typed( constructor );
+         }
+
+         virtual void modify( const object& obj, const std::function<void(object&)>& modify_callback ) override
+         {
+            assert( obj.id.instance() < _objects.size() );
+            modify_callback( _objects[obj.id.instance()] );
+         }
+
+         /** Inserts objects which are sorted by id, allocating the storage once */
+         void load_sorted( vector<T>&& objects )
+         {
+            if( objects.empty() ) return;
+            const auto last = objects.back().id.instance();
+            if( _objects.size() <= last ) _objects.resize( last+1 );
+            for( auto& item : objects )
+            {
+               const auto instance = item.id.instance();
+               _objects[instance] = std::move(item);
+            }
+         }
+
+         template<typename Constructor>
+         const T& create_typed( Constructor&& constructor )
          {
              auto id = get_next_id();
              auto instance = id.instance();
@@ -51,12 +78,18 @@ namespace graphene { namespace db {
              return _objects[instance];
          }
 
-         virtual void modify( const object& obj, const std::function<void(object&)>& modify_callback ) override
+         template<typename Lambda>
+         void modify_typed( const T& obj, const Lambda& modify_callback )
          {
             assert( obj.id.instance() < _objects.size() );
             modify_callback( _objects[obj.id.instance()] );
          }
 
+         void remove_typed( const T& obj )
+         {
+            _objects[obj.id.instance()] = T();
+         }
+
          virtual const object& insert( object&& obj )override
          {
             auto instance = obj.id.instance();
@@ -69,8 +102,7 @@ namespace graphene { namespace db {
          virtual void remove( const object& obj ) override
          {
             assert( nullptr != dynamic_cast<const T*>(&obj) );
-            const auto instance = obj.id.instance();
-            _objects[instance] = T();
+            remove_typed( static_cast<const T&>(obj) );
          }
 
          virtual const object* find( object_id_type id )const override
@@ -45,6 +45,8 @@ namespace graphene { namespace chain {
       public:
          typedef MultiIndexType index_type;
          typedef ObjectType     object_type;
+         /// multi_index nodes stay where they are until erased, see object_table
+         static const bool stable_addresses = true;
 
          virtual const object& insert( object&& obj )override
          {
@@ -55,6 +57,37 @@ namespace graphene { namespace chain {
          }
 
          virtual const object&  create(const std::function<void(object&)>& constructor )override
+         {
+            return create_typed( constructor );
+         }
+
+         virtual void modify( const object& obj, const std::function<void(object&)>& m )override
+         {
+            assert( nullptr != dynamic_cast<const ObjectType*>(&obj) );
+            modify_typed( static_cast<const ObjectType&>(obj), m );
+         }
+
+         virtual void remove( const object& obj )override
+         {
+            remove_typed( static_cast<const ObjectType&>(obj) );
+         }
+
+         /**
+          *  Inserts objects which are sorted by id, as they are when an index is loaded from disk.
+          *  The end of the container is passed as a hint so the id ordered view is appended to.
+          */
+         void load_sorted( vector<ObjectType>&& objects )
+         {
+            for( auto& item : objects )
+            {
+               const auto size = _indices.size();
+               _indices.insert( _indices.end(), std::move(item) );
+               FC_ASSERT( _indices.size() == size + 1, "Could not insert object, most likely a uniqueness constraint was violated" );
+            }
+         }
+
+         template<typename Constructor>
+         const ObjectType& create_typed( Constructor&& constructor )
          {
             ObjectType item;
             item.id = get_next_id();
@@ -65,17 +98,16 @@ namespace graphene { namespace chain {
             return *insert_result.first;
          }
 
-         virtual void modify( const object& obj, const std::function<void(object&)>& m )override
+         template<typename Lambda>
+         void modify_typed( const ObjectType& obj, const Lambda& m )
          {
-            assert( nullptr != dynamic_cast<const ObjectType*>(&obj) );
-            auto ok = _indices.modify( _indices.iterator_to( static_cast<const ObjectType&>(obj) ),
-                                       [&m]( ObjectType& o ){ m(o); } );
+            auto ok = _indices.modify( _indices.iterator_to( obj ), [&m]( ObjectType& o ){ m(o); } );
             FC_ASSERT( ok, "Could not modify object, most likely a index constraint was violated" );
          }
 
-         virtual void remove( const object& obj )override
+         void remove_typed( const ObjectType& obj )
          {
-            _indices.erase( _indices.iterator_to( static_cast<const ObjectType&>(obj) ) );
+            _indices.erase( _indices.iterator_to( obj ) );
          }
 
          virtual const object* find( object_id_type id )const override
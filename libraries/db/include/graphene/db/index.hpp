@@ -23,11 +23,14 @@
  */
 #pragma once
 #include <graphene/db/object.hpp>
+#include <graphene/db/object_table.hpp>
 #include <fc/interprocess/file_mapping.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/io/json.hpp>
 #include <fc/crypto/sha256.hpp>
+#include <algorithm>
 #include <fstream>
+#include <type_traits>
 
 namespace graphene { namespace db {
    class object_database;
@@ -78,6 +81,8 @@ namespace graphene { namespace db {
          virtual void           set_next_id( object_id_type id ) = 0;
 
          virtual const object&  load( const std::vector<char>& data ) = 0;
+         /** Unpacks an object of this index packed by object::pack(), without inserting it */
+         virtual unique_ptr<object> unpack( const std::vector<char>& data )const = 0;
          /**
           *  Polymorphically insert by moving an object into the index.
           *  this should throw if the object is already in the database.
@@ -142,6 +147,77 @@ namespace graphene { namespace db {
          virtual void object_removed( const object& obj ){};
          virtual void about_to_modify( const object& before ){};
          virtual void object_modified( const object& after  ){};
+
+         /**
+          *  True for indexes derived from filtered_secondary_index.  For those primary_index calls
+          *  save_watched_fields() instead of about_to_modify() and only calls object_modified() when
+          *  watched_fields_changed() reports a difference.  release_watched_fields() is called once the
+          *  modification is over, whether or not it succeeded.
+          */
+         bool watches_fields()const { return _watches_fields; }
+         virtual void save_watched_fields( const object& before ){};
+         virtual bool watched_fields_changed( const object& after )const { return true; };
+         virtual void release_watched_fields(){};
+
+      protected:
+         bool _watches_fields = false;
+   };
+
+   /**
+    *  @class filtered_secondary_index
+    *  @brief A secondary index which depends only on some fields of ObjectType
+    *
+    *  FieldsType holds a copy of the watched fields.  It must be default constructible, constructible
+    *  from const ObjectType& and provide bool matches( const ObjectType& )const.  Modifications which
+    *  leave the watched fields unchanged are not reported to the index at all; when they do change,
+    *  object_modified() is called and saved_fields() holds their previous value.  about_to_modify() is
+    *  never called on these indexes.  The saved fields are kept on a stack, so a modification made from
+    *  within the lambda of another one on the same index does not clobber the outer one's fields.
+    */
+   template<typename ObjectType, typename FieldsType>
+   class filtered_secondary_index : public secondary_index
+   {
+      public:
+         filtered_secondary_index() { _watches_fields = true; }
+
+         virtual void save_watched_fields( const object& before ) override
+         {
+            assert( nullptr != dynamic_cast<const ObjectType*>(&before) );
+            _saved_fields.emplace_back( static_cast<const ObjectType&>(before) );
+         }
+
+         virtual bool watched_fields_changed( const object& after )const override
+         {
+            assert( nullptr != dynamic_cast<const ObjectType*>(&after) );
+            return !saved_fields().matches( static_cast<const ObjectType&>(after) );
+         }
+
+         virtual void release_watched_fields() override
+         {
+            assert( !_saved_fields.empty() );
+            _saved_fields.pop_back();
+         }
+
+      protected:
+         const FieldsType& saved_fields()const
+         {
+            assert( !_saved_fields.empty() );
+            return _saved_fields.back();
+         }
+
+      private:
+         /** fields of the objects being modified, innermost modification last */
+         vector<FieldsType> _saved_fields;
+   };
+
+   /** FieldsType for filtered secondary indexes which are not affected by modifications at all */
+   struct no_watched_fields
+   {
+      no_watched_fields(){}
+      template<typename ObjectType>
+      explicit no_watched_fields( const ObjectType& ){}
+      template<typename ObjectType>
+      bool matches( const ObjectType& )const { return true; }
    };
 
    /**
@@ -165,11 +241,21 @@ namespace graphene { namespace db {
          void on_modify( const object& obj );
 
          template<typename T>
-         void add_secondary_index()
+         T* add_secondary_index()
          {
-            _sindex.emplace_back( new T() );
+            T* result = new T();
+            _sindex.emplace_back( result );
+            return result;
          }
 
+         /**
+          *  Record changes to this index in undo segments rather than in the undo state itself.  Meant for
+          *  indexes maintained by plugins which mostly append objects, such as operation history: their objects
+          *  no longer weigh on every undo state, and undoing a block truncates them back in creation order.
+          */
+         void use_segmented_undo() { _segmented_undo = true; }
+         bool segmented_undo()const { return _segmented_undo; }
+
          template<typename T>
          const T& get_secondary_index()const
          {
@@ -182,11 +268,31 @@ namespace graphene { namespace db {
          }
 
       protected:
+         /** Registers the objects of this index in the object_database's object_table */
+         void track_object_addresses( uint8_t space_id, uint8_t type_id );
+         void set_object_address( const object& obj )
+         {
+            if( _object_table ) _object_table->set( obj.id.instance(), &obj );
+         }
+         void clear_object_address( object_id_type id )
+         {
+            if( _object_table ) _object_table->set( id.instance(), nullptr );
+         }
+         /** Lets the secondary indexes which watch fields drop the ones saved for the modification just done */
+         void release_watched_fields()
+         {
+            for( const auto& item : _sindex )
+               if( item->watches_fields() )
+                  item->release_watched_fields();
+         }
+
          vector< shared_ptr<index_observer> >   _observers;
          vector< unique_ptr<secondary_index> >  _sindex;
+         object_table::type_table*              _object_table = nullptr;
 
       private:
          object_database& _db;
+         bool             _segmented_undo = false;
    };
 
 
@@ -204,7 +310,11 @@ namespace graphene { namespace db {
          typedef typename DerivedIndex::object_type object_type;
 
          primary_index( object_database& db )
-         :base_primary_index(db),_next_id(object_type::space_id,object_type::type_id,0) {}
+         :base_primary_index(db),_next_id(object_type::space_id,object_type::type_id,0)
+         {
+            if( DerivedIndex::stable_addresses )
+               track_object_addresses( object_type::space_id, object_type::type_id );
+         }
 
          virtual uint8_t object_space_id()const override
          { return object_type::space_id; }
@@ -216,12 +326,22 @@ namespace graphene { namespace db {
          virtual void           use_next_id()override                    { ++_next_id.number;  }
          virtual void           set_next_id( object_id_type id )override { _next_id = id;      }
 
+         /**
+          *  Version 2.0 of the index file stores the number of objects after the header and each object is
+          *  packed directly.  Version 1.0 files wrapped every object in its own length prefixed vector<char>
+          *  and are still accepted by open().
+          */
          fc::sha256 get_object_version()const
          {
-            std::string desc = "1.0";//get_type_description<object_type>();
+            std::string desc = "2.0";//get_type_description<object_type>();
             return fc::sha256::hash(desc);
          }
 
+         fc::sha256 get_legacy_object_version()const
+         {
+            return fc::sha256::hash(std::string("1.0"));
+         }
+
          virtual void open( const path& db )override
          { 
             if( !fc::exists( db ) ) return;
@@ -232,15 +352,46 @@ namespace graphene { namespace db {
 
             fc::raw::unpack(ds, _next_id);
             fc::raw::unpack(ds, open_ver);
-            FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
-            try {
+
+            vector<object_type> objects;
+            if( open_ver == get_legacy_object_version() )
+            {
                vector<char> tmp;
-               while( true ) 
+               while( ds.remaining() > 0 )
                {
                   fc::raw::unpack( ds, tmp );
-                  load( tmp );
+                  objects.emplace_back( fc::raw::unpack<object_type>( tmp ) );
                }
-            } catch ( const fc::exception&  ){}
+            }
+            else
+            {
+               FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
+               uint64_t count = 0;
+               fc::raw::unpack( ds, count );
+               // Every packed object starts with its 8 byte id.  The count is only trusted as far as the file can
+               // back it, and objects are appended as they are read, so a corrupt count cannot allocate more memory
+               // than the objects actually in the file need.
+               FC_ASSERT( count <= ds.remaining() / sizeof(uint64_t), "Corrupted index file, object count exceeds the file size" );
+               objects.reserve( std::min<uint64_t>( count, ds.remaining() / fc::raw::pack_size( object_type() ) ) );
+               for( uint64_t i = 0; i < count; ++i )
+               {
+                  objects.emplace_back();
+                  fc::raw::unpack( ds, objects.back() );
+               }
+            }
+
+            auto by_object_id = []( const object_type& a, const object_type& b ) { return a.id < b.id; };
+            if( !std::is_sorted( objects.begin(), objects.end(), by_object_id ) )
+               std::sort( objects.begin(), objects.end(), by_object_id );
+            DerivedIndex::load_sorted( std::move(objects) );
+
+            // secondary indexes are built in a single pass once every object is in place
+            if( !_sindex.empty() || _object_table )
+               this->inspect_all_objects( [&]( const object& o ) {
+                  set_object_address( o );
+                  for( const auto& item : _sindex )
+                     item->object_inserted( o );
+               });
          }
 
          virtual void save( const path& db ) override 
@@ -251,48 +402,127 @@ namespace graphene { namespace db {
             auto ver  = get_object_version();
             fc::raw::pack( out, _next_id );
             fc::raw::pack( out, ver );
+            uint64_t count = 0;
+            this->inspect_all_objects( [&]( const object& ) { ++count; } );
+            fc::raw::pack( out, count );
             this->inspect_all_objects( [&]( const object& o ) {
-                auto vec = fc::raw::pack( static_cast<const object_type&>(o) );
-                auto packed_vec = fc::raw::pack( vec );
-                out.write( packed_vec.data(), packed_vec.size() );
+                fc::raw::pack( out, static_cast<const object_type&>(o) );
             });
+            FC_ASSERT( out, "Failed to write index file ${f}", ("f", db.generic_string()) );
          }
 
          virtual const object&  load( const std::vector<char>& data )override
          {
             const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
+            set_object_address( result );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            return result;
+         }
+
+         /** Used by undo to put removed objects back */
+         virtual const object& insert( object&& obj )override
+         {
+            const auto& result = DerivedIndex::insert( std::move(obj) );
+            set_object_address( result );
             for( const auto& item : _sindex )
                item->object_inserted( result );
             return result;
          }
 
 
+         virtual unique_ptr<object> unpack( const std::vector<char>& data )const override
+         {
+            return unique_ptr<object>( new object_type( fc::raw::unpack<object_type>( data ) ) );
+         }
+
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
-            const auto& result = DerivedIndex::create( constructor );
+            return create_typed( constructor );
+         }
+
+         virtual void  remove( const object& obj ) override
+         {
+            remove_typed( static_cast<const object_type&>(obj) );
+         }
+
+         virtual void modify( const object& obj, const std::function<void(object&)>& m )override
+         {
+            modify_typed( static_cast<const object_type&>(obj), m );
+         }
+
+         /**
+          *  Statically typed versions of create, modify and remove.  object_database calls these directly
+          *  for object types with a registered primary_index_of specialization, so the callback is inlined
+          *  instead of being wrapped in a std::function and the derived index is not reached through the
+          *  vtable.  The virtual overrides above forward here as well.
+          */
+         template<typename Constructor>
+         const object_type& create_typed( Constructor&& constructor )
+         {
+            const auto& result = DerivedIndex::create_typed( std::forward<Constructor>(constructor) );
+            set_object_address( result );
             for( const auto& item : _sindex )
                item->object_inserted( result );
             on_add( result );
             return result;
          }
 
-         virtual void  remove( const object& obj ) override
+         template<typename Lambda>
+         void modify_typed( const object_type& obj, const Lambda& m )
+         {
+            save_undo( obj );
+            for( const auto& item : _sindex )
+            {
+               if( item->watches_fields() )
+                  item->save_watched_fields( obj );
+               else
+                  item->about_to_modify( obj );
+            }
+            try
+            {
+               DerivedIndex::modify_typed( obj, m );
+            }
+            catch( ... )
+            {
+               // a multi_index container erases the object if the change violates one of its constraints
+               if( _object_table && DerivedIndex::find( obj.id ) == nullptr )
+                  clear_object_address( obj.id );
+               release_watched_fields();
+               throw;
+            }
+            try
+            {
+               for( const auto& item : _sindex )
+               {
+                  if( !item->watches_fields() || item->watched_fields_changed( obj ) )
+                     item->object_modified( obj );
+               }
+            }
+            catch( ... )
+            {
+               release_watched_fields();
+               throw;
+            }
+            release_watched_fields();
+            if( !_observers.empty() )
+               on_modify( obj );
+         }
+
+         void remove_typed( const object_type& obj )
          {
             for( const auto& item : _sindex )
                item->object_removed( obj );
             on_remove(obj);
-            DerivedIndex::remove(obj);
+            clear_object_address( obj.id );
+            DerivedIndex::remove_typed(obj);
          }
 
-         virtual void modify( const object& obj, const std::function<void(object&)>& m )override
+         /** looks the object up in the object_table when it is tracked, otherwise without going through the vtable */
+         const object* find_typed( object_id_type id )const
          {
-            save_undo( obj );
-            for( const auto& item : _sindex )
-               item->about_to_modify( obj );
-            DerivedIndex::modify( obj, m );
-            for( const auto& item : _sindex )
-               item->object_modified( obj );
-            on_modify( obj );
+            if( _object_table ) return _object_table->find( id.instance() );
+            return DerivedIndex::find( id );
          }
 
          virtual void add_observer( const shared_ptr<index_observer>& o ) override
@@ -322,4 +552,26 @@ namespace graphene { namespace db {
          object_id_type _next_id;
    };
 
+   /**
+    *  Maps an object type to the primary_index it is registered with.  Specializing this (through
+    *  GRAPHENE_DEFINE_PRIMARY_INDEX) lets object_database::create/modify/remove/get/find resolve the
+    *  index at compile time and take the statically typed path.  Types without a specialization use
+    *  the virtual index interface.
+    */
+   template<typename ObjectType>
+   struct primary_index_of { typedef void type; };
+
+   template<typename ObjectType>
+   struct has_primary_index
+      : std::integral_constant<bool, !std::is_void<typename primary_index_of<ObjectType>::type>::value> {};
+
 } } // graphene::db
+
+/**
+ *  Declares INDEX as the index OBJECT is registered with via add_index< primary_index<INDEX> >().
+ *  Must be used at global scope, after both types are complete.
+ */
+#define GRAPHENE_DEFINE_PRIMARY_INDEX( OBJECT, INDEX ) \
+namespace graphene { namespace db { \
+   template<> struct primary_index_of< OBJECT > { typedef primary_index< INDEX > type; }; \
+} }
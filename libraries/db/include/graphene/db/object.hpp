@@ -76,6 +76,8 @@ namespace graphene { namespace db {
          virtual variant            to_variant()const  = 0;
          virtual vector<char>       pack()const = 0;
          virtual fc::uint128        hash()const = 0;
+         /// rough estimate of the memory held by the object: its size plus the size of its serialized content
+         virtual size_t             memory_size()const = 0;
    };
 
    /**
@@ -100,6 +102,7 @@ namespace graphene { namespace db {
          }
          virtual variant to_variant()const { return variant( static_cast<const DerivedClass&>(*this) ); }
          virtual vector<char> pack()const  { return fc::raw::pack( static_cast<const DerivedClass&>(*this) ); }
+         virtual size_t  memory_size()const { return sizeof(DerivedClass) + fc::raw::pack_size( static_cast<const DerivedClass&>(*this) ); }
          virtual fc::uint128  hash()const  {  
              auto tmp = this->pack();
              return fc::city_hash_crc_128( tmp.data(), tmp.size() );
@@ -42,7 +42,7 @@ namespace graphene { namespace db {
          object_database();
          ~object_database();
 
-         void reset_indexes() { _index.clear(); _index.resize(255); }
+         void reset_indexes() { _index.clear(); _index.resize(255); _object_table.clear(); }
 
          void open(const fc::path& data_dir);
 
@@ -56,12 +56,7 @@ namespace graphene { namespace db {
          template<typename T, typename F>
          const T& create( F&& constructor )
          {
-            auto& idx = get_mutable_index<T>();
-            return static_cast<const T&>( idx.create( [&](object& o)
-            {
-               assert( dynamic_cast<T*>(&o) );
-               constructor( static_cast<T&>(o) );
-            } ));
+            return create_impl<T>( constructor, has_primary_index<T>() );
          }
 
          ///These methods are used to retrieve indexes on the object_database. All public index accessors are const-access only.
@@ -75,10 +70,17 @@ namespace graphene { namespace db {
          const index&  get_index()const { return get_index(T::space_id,T::type_id); }
          const index&  get_index(uint8_t space_id, uint8_t type_id)const;
          const index&  get_index(object_id_type id)const { return get_index(id.space(),id.type()); }
+         /// @return the index registered for the given space and type, or nullptr if there is none
+         const index*  find_index(uint8_t space_id, uint8_t type_id)const;
          /// @}
 
          const object& get_object( object_id_type id )const;
          const object* find_object( object_id_type id )const;
+         /**
+          * Looks up many objects at once: result[i] is the object with ids[i], or nullptr if there is none or no
+          * index for its space and type.  Runs of ids of the same space and type share one index lookup.
+          */
+         void find_objects( const vector<object_id_type>& ids, vector<const object*>& result )const;
 
          /// These methods are mutators of the object_database. You must use these methods to make changes to the object_database,
          /// in order to maintain proper undo history.
@@ -86,9 +88,11 @@ namespace graphene { namespace db {
 
          const object& insert( object&& obj ) { return get_mutable_index(obj.id).insert( std::move(obj) ); }
          void          remove( const object& obj ) { get_mutable_index(obj.id).remove( obj ); }
+         template<typename T>
+         void remove( const T& obj ) { remove_impl( obj, has_primary_index<T>() ); }
          template<typename T, typename Lambda>
          void modify( const T& obj, const Lambda& m ) {
-            get_mutable_index(obj.id).modify(obj,m);
+            modify_impl( obj, m, has_primary_index<T>() );
          }
 
          ///@}
@@ -122,15 +126,23 @@ namespace graphene { namespace db {
          }
 
          template<uint8_t SpaceID, uint8_t TypeID, typename T>
-         const T* find( object_id<SpaceID,TypeID,T> id )const { return find<T>(id); }
+         const T* find( object_id<SpaceID,TypeID,T> id )const { return find_impl<T>( id, has_primary_index<T>() ); }
 
          template<uint8_t SpaceID, uint8_t TypeID, typename T>
-         const T& get( object_id<SpaceID,TypeID,T> id )const { return get<T>(id); }
+         const T& get( object_id<SpaceID,TypeID,T> id )const
+         {
+            const T* obj = find_impl<T>( id, has_primary_index<T>() );
+            FC_ASSERT( obj != nullptr, "Unable to find Object", ("id",id) );
+            return *obj;
+         }
 
          template<typename IndexType>
          IndexType* add_index()
          {
             typedef typename IndexType::object_type ObjectType;
+            static_assert( !has_primary_index<ObjectType>::value ||
+                           std::is_same<typename primary_index_of<ObjectType>::type, IndexType>::value,
+                           "IndexType does not match the index declared with GRAPHENE_DEFINE_PRIMARY_INDEX" );
             if( _index[ObjectType::space_id].size() <= ObjectType::type_id  )
                 _index[ObjectType::space_id].resize( 255 );
             assert(!_index[ObjectType::space_id][ObjectType::type_id]);
@@ -156,7 +168,76 @@ namespace graphene { namespace db {
          index& get_mutable_index(object_id_type id)  { return get_mutable_index(id.space(),id.type());   }
          index& get_mutable_index(uint8_t space_id, uint8_t type_id);
 
+         /** @return the primary index of T as declared by primary_index_of<T>, without runtime checks */
+         template<typename T>
+         typename primary_index_of<T>::type& get_mutable_primary_index()
+         {
+            typedef typename primary_index_of<T>::type index_type;
+            index* idx = _index[T::space_id][T::type_id].get();
+            assert( nullptr != dynamic_cast<index_type*>(idx) );
+            return *static_cast<index_type*>(idx);
+         }
+         template<typename T>
+         const typename primary_index_of<T>::type& get_primary_index()const
+         {
+            typedef typename primary_index_of<T>::type index_type;
+            const index* idx = _index[T::space_id][T::type_id].get();
+            assert( nullptr != dynamic_cast<const index_type*>(idx) );
+            return *static_cast<const index_type*>(idx);
+         }
+
      private:
+         template<typename T, typename F>
+         const T& create_impl( F& constructor, std::true_type )
+         {
+            return get_mutable_primary_index<T>().create_typed( constructor );
+         }
+         template<typename T, typename F>
+         const T& create_impl( F& constructor, std::false_type )
+         {
+            auto& idx = get_mutable_index<T>();
+            return static_cast<const T&>( idx.create( [&](object& o)
+            {
+               assert( dynamic_cast<T*>(&o) );
+               constructor( static_cast<T&>(o) );
+            } ));
+         }
+
+         template<typename T, typename Lambda>
+         void modify_impl( const T& obj, const Lambda& m, std::true_type )
+         {
+            assert( obj.id.space() == T::space_id && obj.id.type() == T::type_id );
+            get_mutable_primary_index<T>().modify_typed( obj, m );
+         }
+         template<typename T, typename Lambda>
+         void modify_impl( const T& obj, const Lambda& m, std::false_type )
+         {
+            get_mutable_index(obj.id).modify(obj,m);
+         }
+
+         template<typename T>
+         void remove_impl( const T& obj, std::true_type )
+         {
+            assert( obj.id.space() == T::space_id && obj.id.type() == T::type_id );
+            get_mutable_primary_index<T>().remove_typed( obj );
+         }
+         template<typename T>
+         void remove_impl( const T& obj, std::false_type )
+         {
+            get_mutable_index(obj.id).remove( obj );
+         }
+
+         template<typename T>
+         const T* find_impl( object_id_type id, std::true_type )const
+         {
+            return static_cast<const T*>( get_primary_index<T>().find_typed( id ) );
+         }
+         template<typename T>
+         const T* find_impl( object_id_type id, std::false_type )const
+         {
+            return find<T>( id );
+         }
+
 
          friend class base_primary_index;
          friend class undo_database;
@@ -166,6 +247,8 @@ namespace graphene { namespace db {
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         /// id to object lookup for the indexes with stable object addresses, maintained by primary_index
+         object_table                                              _object_table;
    };
 
 } } // graphene::db
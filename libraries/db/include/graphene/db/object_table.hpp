@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <graphene/db/object.hpp>
+
+#include <array>
+
+namespace graphene { namespace db {
+
+   /**
+    *  @class object_table
+    *  @brief Maps object ids to the objects of indexes whose objects never move in memory
+    *
+    *  A two level radix table: the space and type of an id select a type_table, whose instances are split into
+    *  fixed size pages of object pointers.  Ids are handed out sequentially, so pages fill up densely and a lookup
+    *  is two vector accesses and an array access, with no virtual call and no search.  A page is released as soon as
+    *  the last of its objects is removed, so types with a high turnover only hold the pages of their live objects.
+    *  primary_index keeps the table up to date for the indexes it registered with track().
+    */
+   class object_table
+   {
+      public:
+         static const uint32_t page_bits = 10;
+         static const uint64_t page_size = uint64_t(1) << page_bits;
+
+         class type_table
+         {
+            public:
+               const object* find( uint64_t instance )const
+               {
+                  const uint64_t page = instance >> page_bits;
+                  if( page >= _pages.size() || !_pages[page] ) return nullptr;
+                  return _pages[page]->slots[instance & (page_size - 1)];
+               }
+
+               /** Sets the object stored under instance, nullptr once it is removed */
+               void set( uint64_t instance, const object* obj );
+
+               /** @return the number of pages currently allocated */
+               size_t allocated_pages()const { return _allocated_pages; }
+
+            private:
+               struct page
+               {
+                  std::array<const object*, page_size> slots;
+                  uint32_t                             live = 0;
+               };
+               vector< unique_ptr<page> > _pages;
+               size_t                     _allocated_pages = 0;
+         };
+
+         /** Starts tracking the ids of a space and type; the returned table must be updated by the caller */
+         type_table& track( uint8_t space_id, uint8_t type_id );
+
+         /** @return the table tracking the space and type of id, or nullptr if they are not tracked */
+         const type_table* find_table( object_id_type id )const
+         {
+            if( id.space() >= _tables.size() ) return nullptr;
+            const auto& types = _tables[id.space()];
+            if( id.type() >= types.size() ) return nullptr;
+            return types[id.type()].get();
+         }
+
+         void clear() { _tables.clear(); }
+
+      private:
+         vector< vector< unique_ptr<type_table> > > _tables;
+   };
+
+} } // graphene::db
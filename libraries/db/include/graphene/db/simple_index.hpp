@@ -39,24 +39,62 @@ namespace graphene { namespace db {
    {
       public:
          typedef T object_type;
+         /// objects are allocated one by one, see object_table
+         static const bool stable_addresses = true;
 
          virtual const object&  create( const std::function<void(object&)>& constructor ) override
+         {
+            return create_typed( constructor );
+         }
+
+         virtual void modify( const object& obj, const std::function<void(object&)>& modify_callback ) override
+         {
+            assert( obj.id.instance() < _objects.size() );
+            modify_callback( *_objects[obj.id.instance()] );
+         }
+
+         /** Inserts objects which are sorted by id, allocating the instance table once */
+         void load_sorted( vector<T>&& objects )
+         {
+            if( objects.empty() ) return;
+            const auto last = objects.back().id.instance();
+            if( _objects.size() <= last ) _objects.resize( last+1 );
+            for( auto& item : objects )
+            {
+               const auto instance = item.id.instance();
+               assert( !_objects[instance] );
+               _objects[instance].reset( new T( std::move(item) ) );
+            }
+         }
+
+         template<typename Constructor>
+         const T& create_typed( Constructor&& constructor )
          {
              auto id = get_next_id();
              auto instance = id.instance();
              if( instance >= _objects.size() ) _objects.resize( instance + 1 );
-             _objects[instance].reset(new T);
-             _objects[instance]->id = id;
-             constructor( *_objects[instance] );
-             _objects[instance]->id = id; // just in case it changed
+             T* item = new T;
+             _objects[instance].reset(item);
+             item->id = id;
+             constructor( *item );
+             item->id = id; // just in case it changed
              use_next_id();
-             return *_objects[instance];
+             return *item;
          }
 
-         virtual void modify( const object& obj, const std::function<void(object&)>& modify_callback ) override
+         template<typename Lambda>
+         void modify_typed( const T& obj, const Lambda& modify_callback )
          {
             assert( obj.id.instance() < _objects.size() );
-            modify_callback( *_objects[obj.id.instance()] );
+            modify_callback( static_cast<T&>( *_objects[obj.id.instance()] ) );
+         }
+
+         void remove_typed( const T& obj )
+         {
+            const auto instance = obj.id.instance();
+            _objects[instance].reset();
+            while( (_objects.size() > 0) && (_objects.back() == nullptr) )
+               _objects.pop_back();
          }
 
          virtual const object& insert( object&& obj )override
@@ -72,10 +110,7 @@ namespace graphene { namespace db {
          virtual void remove( const object& obj ) override
          {
             assert( nullptr != dynamic_cast<const T*>(&obj) );
-            const auto instance = obj.id.instance();
-            _objects[instance].reset();
-            while( (_objects.size() > 0) && (_objects.back() == nullptr) )
-               _objects.pop_back();
+            remove_typed( static_cast<const T&>(obj) );
          }
 
          virtual const object* find( object_id_type id )const override
@@ -38,6 +38,46 @@ namespace graphene { namespace db {
       unordered_map<object_id_type, object_id_type>      old_index_next_ids;
       std::unordered_set<object_id_type>                 new_ids;
       unordered_map<object_id_type, unique_ptr<object> > removed;
+
+      /// Estimated memory held by this state, in bytes
+      size_t                                              memory_usage = 0;
+      /// Set once old_values and removed have been packed into packed_old_values and packed_removed to save memory
+      bool                                                compacted = false;
+      vector<std::pair<object_id_type, vector<char>>>     packed_old_values;
+      vector<std::pair<object_id_type, vector<char>>>     packed_removed;
+   };
+
+   /** Undo history figures reported by undo_database::get_stats() */
+   struct undo_stats
+   {
+      uint32_t depth = 0;
+      uint32_t max_depth = 0;
+      uint32_t compacted_depth = 0;
+      uint64_t memory_usage = 0;
+      uint64_t max_memory = 0;
+   };
+
+   /**
+    * Changes made to indexes using segmented undo (see base_primary_index::use_segmented_undo) within one undo
+    * state, typically one block.  Objects of these indexes are created far more often than they are modified, so
+    * instead of hashing every new id the segment keeps the first id created in each index and the new ids in
+    * creation order; undoing it truncates each index back to where the segment started.
+    */
+   struct undo_segment
+   {
+      /// Depth of the undo state this segment belongs to, i.e. the stack size when it was opened
+      size_t                                              depth = 0;
+      unordered_map<object_id_type, object_id_type>      old_index_next_ids;
+      vector<object_id_type>                             new_ids;
+      unordered_map<object_id_type, unique_ptr<object> > old_values;
+      unordered_map<object_id_type, unique_ptr<object> > removed;
+
+      /** @return true if id was created within this segment */
+      bool is_new( object_id_type id )const
+      {
+         auto itr = old_index_next_ids.find( object_id_type( id.space(), id.type(), 0 ) );
+         return itr != old_index_next_ids.end() && id.instance() >= itr->second.instance();
+      }
    };
 
 
@@ -118,6 +158,15 @@ namespace graphene { namespace db {
           */
          void on_remove( const object& obj );
 
+         /**
+          * Same as on_create, on_modify and on_remove but for objects of indexes using segmented undo.  Their changes
+          * are recorded in an undo_segment kept beside the undo state instead of in the state itself, and are
+          * reverted, merged and discarded together with it.
+          */
+         void on_segment_create( const object& obj );
+         void on_segment_modify( const object& obj );
+         void on_segment_remove( const object& obj );
+
          /**
           *  Removes the last committed session,
           *  note... this is dangerous if there are
@@ -127,21 +176,58 @@ namespace graphene { namespace db {
          void pop_commit();
 
          std::size_t size()const { return _stack.size(); }
-         void set_max_size(size_t new_max_size) { _max_size = new_max_size; }
+         /**
+          * Sets how many undo states are kept.  Committed states beyond that belong to irreversible blocks and are
+          * dropped right away instead of when the next session starts.
+          */
+         void set_max_size(size_t new_max_size);
          size_t max_size()const { return _max_size; }
 
+         /**
+          * Sets a soft limit on the memory held by undo states, 0 for none.  Above it the oldest committed states
+          * are compacted, their saved objects packed and unpacked again only if the state is undone.  States are
+          * never dropped to meet the limit, that is left to max_size.  Without a limit memory is not measured.
+          */
+         void set_max_memory(size_t bytes);
+         size_t max_memory()const { return _max_memory; }
+         /// Estimated memory held by all undo states, in bytes; 0 while there is no limit
+         size_t memory_usage()const { return _memory_usage; }
+         undo_stats get_stats()const;
+
          const undo_state& head()const;
+         /** @return the segmented changes belonging to the head undo state, or nullptr if there are none */
+         const undo_segment* head_segment()const;
 
       private:
          void undo();
          void merge();
          void commit();
 
+         undo_segment& current_segment();
+         /** reverts and drops the segment of the head undo state, if any; the database must be disabled */
+         void undo_head_segment();
+         void merge_head_segment();
+         void drop_oldest_state();
+
+         void compact_to_limit();
+         void compact( undo_state& state );
+         void expand( undo_state& state );
+         /** recomputes the memory held by the state, which is 0 while there is no limit */
+         void measure( undo_state& state );
+         bool tracks_memory()const { return _max_memory != 0; }
+         void add_memory( undo_state& state, size_t bytes ) { state.memory_usage += bytes; _memory_usage += bytes; }
+         void pop_state();
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
          std::deque<undo_state>  _stack;
+         std::deque<undo_segment> _segments;
          object_database&        _db;
          size_t                  _max_size = 256;
+         size_t                  _max_memory = 0;
+         size_t                  _memory_usage = 0;
    };
 
 } } // graphene::db
+
+FC_REFLECT( graphene::db::undo_stats, (depth)(max_depth)(compacted_depth)(memory_usage)(max_memory) )
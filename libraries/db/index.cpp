@@ -27,16 +27,29 @@
 
 namespace graphene { namespace db {
    void base_primary_index::save_undo( const object& obj )
-   { _db.save_undo( obj ); }
+   {
+      if( _segmented_undo ) _db._undo_db.on_segment_modify( obj );
+      else _db.save_undo( obj );
+   }
 
    void base_primary_index::on_add( const object& obj )
    {
-      _db.save_undo_add( obj );
+      if( _segmented_undo ) _db._undo_db.on_segment_create( obj );
+      else _db.save_undo_add( obj );
       for( auto ob : _observers ) ob->on_add( obj );
    }
 
    void base_primary_index::on_remove( const object& obj )
-   { _db.save_undo_remove( obj ); for( auto ob : _observers ) ob->on_remove( obj ); }
+   {
+      if( _segmented_undo ) _db._undo_db.on_segment_remove( obj );
+      else _db.save_undo_remove( obj );
+      for( auto ob : _observers ) ob->on_remove( obj );
+   }
+
+   void base_primary_index::track_object_addresses( uint8_t space_id, uint8_t type_id )
+   {
+      _object_table = &_db._object_table.track( space_id, type_id );
+   }
 
    void base_primary_index::on_modify( const object& obj )
    {for( auto ob : _observers ) ob->on_modify(  obj ); }
@@ -44,11 +44,35 @@ void object_database::close()
 
 const object* object_database::find_object( object_id_type id )const
 {
+   if( const auto table = _object_table.find_table( id ) )
+      return table->find( id.instance() );
    return get_index(id.space(),id.type()).find( id );
 }
+void object_database::find_objects( const vector<object_id_type>& ids, vector<const object*>& result )const
+{
+   result.assign( ids.size(), nullptr );
+
+   const object_table::type_table* table = nullptr;
+   const index* idx = nullptr;
+   for( size_t i = 0; i < ids.size(); ++i )
+   {
+      const object_id_type id = ids[i];
+      if( i == 0 || id.space_type() != ids[i-1].space_type() )
+      {
+         table = _object_table.find_table( id );
+         idx = table ? nullptr : find_index( id.space(), id.type() );
+      }
+      if( table != nullptr )
+         result[i] = table->find( id.instance() );
+      else if( idx != nullptr )
+         result[i] = idx->find( id );
+   }
+}
 const object& object_database::get_object( object_id_type id )const
 {
-   return get_index(id.space(),id.type()).get( id );
+   const object* obj = find_object( id );
+   FC_ASSERT( obj != nullptr, "Unable to find Object", ("id",id) );
+   return *obj;
 }
 
 const index& object_database::get_index(uint8_t space_id, uint8_t type_id)const
@@ -59,6 +83,12 @@ const index& object_database::get_index(uint8_t space_id, uint8_t type_id)const
    FC_ASSERT( tmp );
    return *tmp;
 }
+const index* object_database::find_index(uint8_t space_id, uint8_t type_id)const
+{
+   if( _index.size() <= space_id || _index[space_id].size() <= type_id )
+      return nullptr;
+   return _index[space_id][type_id].get();
+}
 index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
 {
    FC_ASSERT( _index.size() > space_id, "", ("space_id",space_id)("type_id",type_id)("index.size",_index.size()) );
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/db/object_table.hpp>
+
+namespace graphene { namespace db {
+
+void object_table::type_table::set( uint64_t instance, const object* obj )
+{
+   const uint64_t page_num = instance >> page_bits;
+   if( page_num >= _pages.size() )
+   {
+      if( obj == nullptr ) return;
+      _pages.resize( page_num + 1 );
+   }
+   auto& p = _pages[page_num];
+   if( !p )
+   {
+      if( obj == nullptr ) return;
+      p.reset( new page() );
+      p->slots.fill( nullptr );
+      ++_allocated_pages;
+   }
+
+   const object*& slot = p->slots[instance & (page_size - 1)];
+   if( slot == nullptr && obj != nullptr )
+      ++p->live;
+   else if( slot != nullptr && obj == nullptr )
+      --p->live;
+   slot = obj;
+
+   if( p->live == 0 )
+   {
+      p.reset();
+      --_allocated_pages;
+      // Drop the trailing empty slots too, ids are mostly removed in the order they were created
+      while( !_pages.empty() && !_pages.back() )
+         _pages.pop_back();
+   }
+}
+
+object_table::type_table& object_table::track( uint8_t space_id, uint8_t type_id )
+{
+   if( _tables.size() <= space_id ) _tables.resize( space_id + 1 );
+   auto& types = _tables[space_id];
+   if( types.size() <= type_id ) types.resize( type_id + 1 );
+   if( !types[type_id] ) types[type_id].reset( new type_table() );
+   return *types[type_id];
+}
+
+} } // graphene::db
@@ -27,6 +27,11 @@
 
 namespace graphene { namespace db {
 
+namespace {
+   /// rough cost of one entry in the maps and sets of an undo_state, on top of the object it holds
+   const size_t undo_entry_overhead = 64;
+}
+
 void undo_database::enable()  { _disabled = false; }
 void undo_database::disable() { _disabled = true; }
 
@@ -38,7 +43,7 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
       _disabled = false;
 
    while( size() > max_size() )
-      _stack.pop_front();
+      drop_oldest_state();
 
    _stack.emplace_back();
    ++_active_sessions;
@@ -51,11 +56,14 @@ void undo_database::on_create( const object& obj )
    if( _stack.empty() )
       _stack.emplace_back();
    auto& state = _stack.back();
+   expand( state );
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
    if( itr == state.old_index_next_ids.end() )
       state.old_index_next_ids[index_id] = obj.id;
    state.new_ids.insert(obj.id);
+   if( tracks_memory() )
+      add_memory( state, undo_entry_overhead );
 }
 void undo_database::on_modify( const object& obj )
 {
@@ -64,11 +72,15 @@ void undo_database::on_modify( const object& obj )
    if( _stack.empty() )
       _stack.emplace_back();
    auto& state = _stack.back();
+   expand( state );
    if( state.new_ids.find(obj.id) != state.new_ids.end() )
       return;
    auto itr =  state.old_values.find(obj.id);
    if( itr != state.old_values.end() ) return;
    state.old_values[obj.id] = obj.clone();
+   // measuring packs the object, which is only worth it when there is a limit to keep
+   if( tracks_memory() )
+      add_memory( state, undo_entry_overhead + obj.memory_size() );
 }
 void undo_database::on_remove( const object& obj )
 {
@@ -77,6 +89,7 @@ void undo_database::on_remove( const object& obj )
    if( _stack.empty() )
       _stack.emplace_back();
    undo_state& state = _stack.back();
+   expand( state );
    if( state.new_ids.count(obj.id) )
    {
       state.new_ids.erase(obj.id);
@@ -90,6 +103,144 @@ void undo_database::on_remove( const object& obj )
    }
    if( state.removed.count(obj.id) ) return;
    state.removed[obj.id] = obj.clone();
+   if( tracks_memory() )
+      add_memory( state, undo_entry_overhead + obj.memory_size() );
+}
+
+undo_segment& undo_database::current_segment()
+{
+   if( _stack.empty() )
+      _stack.emplace_back();
+   if( _segments.empty() || _segments.back().depth != _stack.size() )
+   {
+      _segments.emplace_back();
+      _segments.back().depth = _stack.size();
+   }
+   return _segments.back();
+}
+void undo_database::on_segment_create( const object& obj )
+{
+   if( _disabled ) return;
+
+   auto& segment = current_segment();
+   auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
+   if( segment.old_index_next_ids.find( index_id ) == segment.old_index_next_ids.end() )
+      segment.old_index_next_ids[index_id] = obj.id;
+   segment.new_ids.push_back( obj.id );
+}
+void undo_database::on_segment_modify( const object& obj )
+{
+   if( _disabled ) return;
+
+   auto& segment = current_segment();
+   if( segment.is_new( obj.id ) )
+      return;
+   if( segment.old_values.find( obj.id ) != segment.old_values.end() )
+      return;
+   segment.old_values[obj.id] = obj.clone();
+}
+void undo_database::on_segment_remove( const object& obj )
+{
+   if( _disabled ) return;
+
+   auto& segment = current_segment();
+   // new objects stay listed in new_ids, undoing the segment skips the ones no longer there
+   if( segment.is_new( obj.id ) )
+      return;
+   auto itr = segment.old_values.find( obj.id );
+   if( itr != segment.old_values.end() )
+   {
+      segment.removed[obj.id] = std::move( itr->second );
+      segment.old_values.erase( itr );
+      return;
+   }
+   if( segment.removed.count( obj.id ) ) return;
+   segment.removed[obj.id] = obj.clone();
+}
+
+void undo_database::undo_head_segment()
+{
+   if( _segments.empty() || _segments.back().depth != _stack.size() )
+      return;
+
+   auto& segment = _segments.back();
+   for( auto& item : segment.old_values )
+      _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
+
+   for( auto ritr = segment.new_ids.rbegin(); ritr != segment.new_ids.rend(); ++ritr )
+   {
+      const object* obj = _db.find_object( *ritr );
+      if( obj != nullptr )
+         _db.remove( *obj );
+   }
+
+   for( auto& item : segment.old_index_next_ids )
+      _db.get_mutable_index( item.first.space(), item.first.type() ).set_next_id( item.second );
+
+   for( auto& item : segment.removed )
+      _db.insert( std::move(*item.second) );
+
+   _segments.pop_back();
+}
+
+void undo_database::merge_head_segment()
+{
+   if( _segments.empty() || _segments.back().depth != _stack.size() )
+      return;
+   if( _segments.size() < 2 || _segments[_segments.size()-2].depth != _stack.size() - 1 )
+   {
+      // nothing to merge with, the segment simply moves down to the previous state
+      --_segments.back().depth;
+      return;
+   }
+
+   // same rules as for merging undo states, see merge()
+   auto& segment = _segments.back();
+   auto& prev_segment = _segments[_segments.size()-2];
+
+   for( auto& item : segment.old_values )
+   {
+      if( prev_segment.is_new( item.first ) || prev_segment.old_values.count( item.first ) )
+         continue;
+      prev_segment.old_values[item.first] = std::move( item.second );
+   }
+
+   for( auto& item : segment.old_index_next_ids )
+      if( prev_segment.old_index_next_ids.find( item.first ) == prev_segment.old_index_next_ids.end() )
+         prev_segment.old_index_next_ids[item.first] = item.second;
+   prev_segment.new_ids.insert( prev_segment.new_ids.end(), segment.new_ids.begin(), segment.new_ids.end() );
+
+   for( auto& item : segment.removed )
+   {
+      if( prev_segment.is_new( item.first ) )
+         continue;
+      auto it = prev_segment.old_values.find( item.first );
+      if( it != prev_segment.old_values.end() )
+      {
+         prev_segment.removed[item.first] = std::move( it->second );
+         prev_segment.old_values.erase( it );
+         continue;
+      }
+      prev_segment.removed[item.first] = std::move( item.second );
+   }
+
+   _segments.pop_back();
+}
+
+void undo_database::pop_state()
+{
+   _memory_usage -= _stack.back().memory_usage;
+   _stack.pop_back();
+}
+
+void undo_database::drop_oldest_state()
+{
+   _memory_usage -= _stack.front().memory_usage;
+   _stack.pop_front();
+   while( !_segments.empty() && _segments.front().depth <= 1 )
+      _segments.pop_front();
+   for( auto& segment : _segments )
+      --segment.depth;
 }
 
 void undo_database::undo()
@@ -98,7 +249,10 @@ void undo_database::undo()
    FC_ASSERT( _active_sessions > 0 );
    disable();
 
+   undo_head_segment();
+
    auto& state = _stack.back();
+   expand( state );
    for( auto& item : state.old_values )
    {
       _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
@@ -117,7 +271,7 @@ void undo_database::undo()
    for( auto& item : state.removed )
       _db.insert( std::move(*item.second) );
 
-   _stack.pop_back();
+   pop_state();
    enable();
    --_active_sessions;
 } FC_CAPTURE_AND_RETHROW() }
@@ -127,13 +281,19 @@ void undo_database::merge()
    FC_ASSERT( _active_sessions > 0 );
    if( _active_sessions == 1 && _stack.size() == 1 )
    {
-      _stack.pop_back();
+      if( !_segments.empty() && _segments.back().depth == 1 )
+         _segments.pop_back();
+      pop_state();
       --_active_sessions;
       return;
    }
    FC_ASSERT( _stack.size() >=2 );
    auto& state = _stack.back();
    auto& prev_state = _stack[_stack.size()-2];
+   expand( prev_state );
+   // the merged state keeps what both held, which overestimates it when entries cancel out
+   prev_state.memory_usage += state.memory_usage;
+   state.memory_usage = 0;
 
    // An object's relationship to a state can be:
    // in new_ids            : new
@@ -239,13 +399,109 @@ void undo_database::merge()
       // nop + del(was=Y) -> del(was=Y)
       prev_state.removed[obj.second->id] = std::move(obj.second);
    }
-   _stack.pop_back();
+   merge_head_segment();
+   pop_state();
    --_active_sessions;
 }
 void undo_database::commit()
 {
    FC_ASSERT( _active_sessions > 0 );
    --_active_sessions;
+   compact_to_limit();
+}
+
+void undo_database::set_max_size( size_t new_max_size )
+{
+   _max_size = new_max_size;
+   // committed states beyond max_size belong to irreversible blocks
+   while( _stack.size() > _max_size && _stack.size() > _active_sessions )
+      drop_oldest_state();
+   compact_to_limit();
+}
+
+void undo_database::set_max_memory( size_t bytes )
+{
+   const bool tracked = tracks_memory();
+   _max_memory = bytes;
+   // usage is not measured without a limit, so it is measured anew whenever one is set or lifted
+   if( tracked != tracks_memory() )
+      for( auto& state : _stack )
+         measure( state );
+   compact_to_limit();
+}
+
+void undo_database::compact_to_limit()
+{
+   if( _max_memory == 0 || _memory_usage <= _max_memory )
+      return;
+   // states of active sessions may still be merged into or read by notifications, only committed ones are packed
+   const size_t committed = _stack.size() > _active_sessions ? _stack.size() - _active_sessions : 0;
+   for( size_t i = 0; i < committed && _memory_usage > _max_memory; ++i )
+      if( !_stack[i].compacted )
+         compact( _stack[i] );
+}
+
+void undo_database::compact( undo_state& state )
+{
+   state.packed_old_values.reserve( state.old_values.size() );
+   for( auto& item : state.old_values )
+      state.packed_old_values.emplace_back( item.first, item.second->pack() );
+   state.packed_removed.reserve( state.removed.size() );
+   for( auto& item : state.removed )
+      state.packed_removed.emplace_back( item.first, item.second->pack() );
+   state.old_values.clear();
+   state.removed.clear();
+   state.compacted = true;
+
+   measure( state );
+}
+
+void undo_database::expand( undo_state& state )
+{
+   if( !state.compacted )
+      return;
+
+   for( auto& item : state.packed_old_values )
+      state.old_values[item.first] = _db.get_index( item.first.space(), item.first.type() ).unpack( item.second );
+   for( auto& item : state.packed_removed )
+      state.removed[item.first] = _db.get_index( item.first.space(), item.first.type() ).unpack( item.second );
+   state.packed_old_values.clear();
+   state.packed_removed.clear();
+   state.compacted = false;
+
+   measure( state );
+}
+
+void undo_database::measure( undo_state& state )
+{
+   size_t usage = 0;
+   if( tracks_memory() )
+   {
+      usage = state.new_ids.size() * undo_entry_overhead;
+      for( const auto& item : state.old_values )
+         usage += undo_entry_overhead + item.second->memory_size();
+      for( const auto& item : state.removed )
+         usage += undo_entry_overhead + item.second->memory_size();
+      for( const auto& item : state.packed_old_values )
+         usage += undo_entry_overhead + item.second.size();
+      for( const auto& item : state.packed_removed )
+         usage += undo_entry_overhead + item.second.size();
+   }
+   _memory_usage = _memory_usage - state.memory_usage + usage;
+   state.memory_usage = usage;
+}
+
+undo_stats undo_database::get_stats()const
+{
+   undo_stats result;
+   result.depth = _stack.size();
+   result.max_depth = _max_size;
+   for( const auto& state : _stack )
+      if( state.compacted )
+         ++result.compacted_depth;
+   result.memory_usage = _memory_usage;
+   result.max_memory = _max_memory;
+   return result;
 }
 
 void undo_database::pop_commit()
@@ -255,7 +511,10 @@ void undo_database::pop_commit()
 
    disable();
    try {
+      undo_head_segment();
+
       auto& state = _stack.back();
+      expand( state );
 
       for( auto& item : state.old_values )
       {
@@ -275,7 +534,7 @@ void undo_database::pop_commit()
       for( auto& item : state.removed )
          _db.insert( std::move(*item.second) );
 
-      _stack.pop_back();
+      pop_state();
    }
    catch ( const fc::exception& e )
    {
@@ -290,5 +549,11 @@ const undo_state& undo_database::head()const
    FC_ASSERT( !_stack.empty() );
    return _stack.back();
 }
+const undo_segment* undo_database::head_segment()const
+{
+   if( _segments.empty() || _segments.back().depth != _stack.size() )
+      return nullptr;
+   return &_segments.back();
+}
 
 } } // graphene::db
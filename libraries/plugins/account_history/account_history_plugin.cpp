@@ -24,19 +24,21 @@
 
 #include <graphene/account_history/account_history_plugin.hpp>
 
-#include <graphene/app/impacted.hpp>
-
 #include <graphene/chain/account_evaluator.hpp>
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/config.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/impacted_accounts.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/transaction_evaluation_state.hpp>
 
 #include <fc/smart_ref_impl.hpp>
 #include <fc/thread/thread.hpp>
 
+#include <algorithm>
+#include <deque>
+
 namespace graphene { namespace account_history {
 
 namespace detail
@@ -57,6 +59,25 @@ class account_history_plugin_impl
        */
       void update_account_histories( const signed_block& b );
 
+      /** applied_block callback used instead of update_account_histories when history is indexed asynchronously;
+       * copies the block's operations and hands them to the history thread.
+       */
+      void enqueue_account_histories( const signed_block& b );
+
+      /** waits for every queued block to be indexed */
+      void drain();
+
+      /**
+       * loads the store saved at the last shutdown, or starts numbering where the database's operation history
+       * ends when it cannot be used; last_applied_block is the block the next batch follows
+       */
+      void open_store( uint32_t last_applied_block );
+
+      fc::path store_file()
+      {
+         return database().get_data_dir() / "account_history_store";
+      }
+
       graphene::chain::database& database()
       {
          return _self.database();
@@ -64,13 +85,92 @@ class account_history_plugin_impl
 
       account_history_plugin& _self;
       flat_set<account_id_type> _tracked_accounts;
+
+      // Asynchronous indexing, only set up when --history-async-shards is given:
+      std::unique_ptr<sharded_history_store> _store;
+      std::unique_ptr<fc::thread>            _history_thread;
+      bool                                   _store_opened = false;
+      std::deque<fc::future<void>>           _in_flight;
+      uint32_t                               _max_history_lag = 1000;
 };
 
 account_history_plugin_impl::~account_history_plugin_impl()
 {
+   drain();
    return;
 }
 
+void account_history_plugin_impl::enqueue_account_histories( const signed_block& b )
+{
+   graphene::chain::database& db = database();
+   if( !_store_opened )
+      open_store( b.block_num() - 1 );
+
+   auto batch = std::make_shared<history_batch>();
+   batch->block_num = b.block_num();
+   const auto copy = [&b]( const vector<optional<operation_history_object>>& from,
+                           vector<optional<operation_history_object>>& to ) {
+      to = from;
+      for( auto& o_op : to )
+         if( o_op.valid() )
+            o_op->block_timestamp = b.timestamp;
+   };
+   copy( db.get_virtual_ops_and_clear_collection(), batch->unlinked );
+   copy( db.get_applied_operations(), batch->operations );
+
+   _in_flight.push_back( _history_thread->async( [this, batch]() {
+      _store->apply( std::move(*batch),
+                     []( const operation_history_object& op, impacted_accounts_buffer& impacted ) {
+                        operation_get_history_accounts( op.op.to_operation(), op.result, impacted );
+                     },
+                     [this]( account_id_type account ) {
+                        return _tracked_accounts.empty() || _tracked_accounts.find( account ) != _tracked_accounts.end();
+                     } );
+   }, "account history indexing" ) );
+
+   while( !_in_flight.empty() && _in_flight.front().ready() )
+      _in_flight.pop_front();
+
+   // Back-pressure: don't let indexing fall more than _max_history_lag blocks behind the chain
+   while( _in_flight.size() > _max_history_lag )
+   {
+      _in_flight.front().wait();
+      _in_flight.pop_front();
+   }
+}
+
+void account_history_plugin_impl::drain()
+{
+   for( auto& f : _in_flight )
+   {
+      try
+      {
+         f.wait();
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "account history indexing failed: ${e}", ("e", e.to_detail_string()) );
+      }
+   }
+   _in_flight.clear();
+}
+
+void account_history_plugin_impl::open_store( uint32_t last_applied_block )
+{
+   _store_opened = true;
+   const fc::path file = store_file();
+   if( _store->load( file, last_applied_block ) )
+   {
+      ilog( "Loaded account history indexed up to block ${n} from ${f}",
+            ("n", _store->indexed_block_num())("f", file.generic_string()) );
+      return;
+   }
+   if( fc::exists( file ) )
+      wlog( "Account history in ${f} does not reach block ${n}; replay the blockchain to index the missing blocks",
+            ("f", file.generic_string())("n", last_applied_block) );
+   _store->start_numbering_at( database().get_index_type<operation_history_index>().get_next_id().instance() );
+}
+
 void account_history_plugin_impl::update_account_histories( const signed_block& b )
 {
    graphene::chain::database& db = database();
@@ -122,18 +222,8 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
       const operation_history_object& op = *o_op;
 
       // get the set of accounts this operation applies to
-      flat_set<account_id_type> impacted;
-      vector<authority> other;
-      operation_get_required_authorities( op.op, impacted, impacted, other );
-
-      if( op.op.which() == operation::tag< account_create_operation >::value )
-         impacted.insert( oho_valid_pair.first.result.get<object_id_type>() );
-      else
-         graphene::app::operation_get_impacted_accounts( op.op, impacted );
-
-      for( auto& a : other )
-         for( auto& item : a.account_auths )
-            impacted.insert( item.first );
+      impacted_accounts_buffer impacted;
+      operation_get_history_accounts( op.op.to_operation(), oho_valid_pair.first.result, impacted );
 
       // for each operation this account applies to that is in the config link it into the history
       if( _tracked_accounts.size() == 0 )
@@ -161,7 +251,7 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
       {
          for( auto account_id : _tracked_accounts )
          {
-            if( impacted.find( account_id ) != impacted.end() )
+            if( std::find( impacted.begin(), impacted.end(), account_id ) != impacted.end() )
             {
                // add history
                const auto& stats_obj = account_id(db).statistics(db);
@@ -205,21 +295,64 @@ void account_history_plugin::plugin_set_program_options(
 {
    cli.add_options()
          ("track-account", boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(), "Account ID to track history for (may specify multiple times)")
+         ("history-async-shards", boost::program_options::value<uint32_t>(),
+          "Index account history on a separate thread into a store with this many shards instead of the chain database")
+         ("history-max-lag", boost::program_options::value<uint32_t>()->default_value(1000),
+          "Number of blocks asynchronous history indexing may fall behind before block application waits for it")
          ;
    cfg.add(cli);
 }
 
 void account_history_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 {
-   database().applied_block.connect( [&]( const signed_block& b){ my->update_account_histories(b); } );
-   database().add_index< primary_index< operation_history_index > >();
-   database().add_index< primary_index< account_transaction_history_index > >();
+   if( options.count( "history-async-shards" ) && options["history-async-shards"].as<uint32_t>() > 0 )
+   {
+      my->_store.reset( new sharded_history_store( options["history-async-shards"].as<uint32_t>() ) );
+      my->_history_thread.reset( new fc::thread( "account_history" ) );
+      if( options.count( "history-max-lag" ) )
+         my->_max_history_lag = std::max( options["history-max-lag"].as<uint32_t>(), 1u );
+      database().applied_block.connect( [&]( const signed_block& b){ my->enqueue_account_histories(b); } );
+   }
+   else
+      database().applied_block.connect( [&]( const signed_block& b){ my->update_account_histories(b); } );
+   database().add_index< primary_index< operation_history_index > >()->use_segmented_undo();
+   database().add_index< primary_index< account_transaction_history_index > >()->use_segmented_undo();
 
    LOAD_VALUE_SET(options, "tracked-accounts", my->_tracked_accounts, graphene::chain::account_id_type);
 }
 
 void account_history_plugin::plugin_startup()
 {
+   if( my->_store && !my->_store_opened )
+      my->open_store( database().head_block_num() );
+}
+
+void account_history_plugin::plugin_shutdown()
+{
+   my->drain();
+   if( my->_history_thread )
+      my->_history_thread->quit();
+   if( my->_store && my->_store_opened )
+   {
+      try
+      {
+         my->_store->save( my->store_file() );
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "Failed to save account history: ${e}", ("e", e.to_detail_string()) );
+      }
+   }
+}
+
+void account_history_plugin::wait_for_async_history()
+{
+   my->drain();
+}
+
+const sharded_history_store* account_history_plugin::async_history()const
+{
+   return my->_store.get();
 }
 
 flat_set<account_id_type> account_history_plugin::tracked_accounts() const
@@ -0,0 +1,324 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/account_history/history_store.hpp>
+
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace graphene { namespace account_history {
+
+namespace {
+   /// Changes whenever the layout of the saved store changes
+   const uint32_t saved_store_version = 1;
+
+   struct number_less
+   {
+      bool operator()( const sharded_history_store::logged_operation& op, uint64_t number )const { return op.id < number; }
+   };
+}
+
+sharded_history_store::logged_operation::logged_operation( const operation_history_object& o, uint64_t number )
+   : id( number ),
+     op( o.op ),
+     result( o.result ),
+     block_num( o.block_num ),
+     block_timestamp( o.block_timestamp ),
+     trx_in_block( o.trx_in_block ),
+     op_in_trx( o.op_in_trx ),
+     virtual_op( o.virtual_op )
+{}
+
+operation_history_object sharded_history_store::logged_operation::to_object()const
+{
+   // the copy shares an operation stored out of line instead of duplicating it
+   operation_history_object o;
+   o.op = op;
+   o.id = operation_history_id_type( id );
+   o.result = result;
+   o.block_num = block_num;
+   o.block_timestamp = block_timestamp;
+   o.trx_in_block = trx_in_block;
+   o.op_in_trx = op_in_trx;
+   o.virtual_op = virtual_op;
+   return o;
+}
+
+sharded_history_store::sharded_history_store( uint32_t shard_count )
+{
+   FC_ASSERT( shard_count > 0 );
+   _shards.reserve( shard_count );
+   for( uint32_t i = 0; i < shard_count; ++i )
+      _shards.emplace_back( new shard );
+}
+
+void sharded_history_store::start_numbering_at( uint64_t next_id )
+{
+   std::lock_guard<std::mutex> lock( _log_mutex );
+   FC_ASSERT( _log.empty() && _block_first_ids.empty(), "Operations are numbered already" );
+   _next_id = next_id;
+}
+
+void sharded_history_store::apply( history_batch&& batch,
+                                   const std::function<void(const operation_history_object&, impacted_accounts_buffer&)>& impacted_accounts,
+                                   const std::function<bool(account_id_type)>& is_tracked )
+{
+   if( _indexed_block_num.load() != 0 && batch.block_num <= _indexed_block_num.load() )
+      rewind_to( batch.block_num );
+
+   // Work out the accounts of every operation before taking any lock
+   vector<impacted_accounts_buffer> impacted( batch.operations.size() );
+   for( size_t i = 0; i < batch.operations.size(); ++i )
+      if( batch.operations[i].valid() )
+         impacted_accounts( *batch.operations[i], impacted[i] );
+
+   uint64_t first_linked;
+   {
+      std::lock_guard<std::mutex> lock( _log_mutex );
+      if( !batch.unlinked.empty() || !batch.operations.empty() )
+         _block_first_ids.emplace_back( batch.block_num, _next_id );
+      for( const auto& op : batch.unlinked )
+      {
+         if( op.valid() )
+            _log.emplace_back( *op, _next_id );
+         ++_next_id;
+      }
+      first_linked = _next_id;
+      for( const auto& op : batch.operations )
+      {
+         if( op.valid() )
+            _log.emplace_back( *op, _next_id );
+         ++_next_id;
+      }
+   }
+
+   // Group the new entries by shard so that each shard is locked once per block
+   vector<vector<std::pair<account_id_type, uint64_t>>> by_shard( _shards.size() );
+   for( size_t i = 0; i < impacted.size(); ++i )
+      for( const auto& account : impacted[i] )
+         if( is_tracked( account ) )
+            by_shard[account.instance.value % _shards.size()].emplace_back( account, first_linked + i );
+
+   for( size_t s = 0; s < _shards.size(); ++s )
+   {
+      if( by_shard[s].empty() )
+         continue;
+      std::lock_guard<std::mutex> lock( _shards[s]->mutex );
+      for( const auto& entry : by_shard[s] )
+         _shards[s]->account_ops[entry.first.instance.value].push_back( entry.second );
+   }
+
+   _indexed_block_num.store( batch.block_num );
+}
+
+void sharded_history_store::rewind_to( uint32_t block_num )
+{
+   uint64_t first_dropped;
+   {
+      std::lock_guard<std::mutex> lock( _log_mutex );
+      while( !_block_first_ids.empty() && _block_first_ids.back().first >= block_num )
+      {
+         _next_id = _block_first_ids.back().second;
+         _block_first_ids.pop_back();
+      }
+      first_dropped = _next_id;
+      while( !_log.empty() && _log.back().id >= first_dropped )
+         _log.pop_back();
+   }
+
+   // Every account has to be visited as the dropped operations do not say whose they were; forks are rare
+   for( auto& s : _shards )
+   {
+      std::lock_guard<std::mutex> lock( s->mutex );
+      for( auto itr = s->account_ops.begin(); itr != s->account_ops.end(); )
+      {
+         auto& ops = itr->second;
+         while( !ops.empty() && ops.back() >= first_dropped )
+            ops.pop_back();
+         if( ops.empty() )
+            itr = s->account_ops.erase( itr );
+         else
+            ++itr;
+      }
+   }
+   _indexed_block_num.store( std::min( _indexed_block_num.load(), block_num - 1 ) );
+}
+
+void sharded_history_store::save( const fc::path& file )const
+{
+   std::ofstream out( file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+   FC_ASSERT( out, "Unable to open ${f}", ("f", file.generic_string()) );
+
+   std::lock_guard<std::mutex> lock( _log_mutex );
+   fc::raw::pack( out, saved_store_version );
+   fc::raw::pack( out, _indexed_block_num.load() );
+   fc::raw::pack( out, _next_id );
+   fc::raw::pack( out, vector<std::pair<uint32_t, uint64_t>>( _block_first_ids.begin(), _block_first_ids.end() ) );
+   fc::raw::pack( out, uint64_t( _log.size() ) );
+   for( const auto& op : _log )
+      fc::raw::pack( out, op );
+   fc::raw::pack( out, uint32_t( _shards.size() ) );
+   for( const auto& s : _shards )
+   {
+      std::lock_guard<std::mutex> shard_lock( s->mutex );
+      fc::raw::pack( out, uint64_t( s->account_ops.size() ) );
+      for( const auto& item : s->account_ops )
+      {
+         fc::raw::pack( out, item.first );
+         fc::raw::pack( out, item.second );
+      }
+   }
+   FC_ASSERT( out, "Failed to write account history file ${f}", ("f", file.generic_string()) );
+}
+
+bool sharded_history_store::load( const fc::path& file, uint32_t last_applied_block )
+{ try {
+   {
+      std::lock_guard<std::mutex> lock( _log_mutex );
+      FC_ASSERT( _log.empty() && _block_first_ids.empty() && _indexed_block_num.load() == 0,
+                 "Account history can only be loaded into an empty store" );
+   }
+   if( !fc::exists( file ) )
+      return false;
+
+   fc::file_mapping fm( file.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( file ) );
+   fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+
+   uint32_t version = 0;
+   fc::raw::unpack( ds, version );
+   if( version != saved_store_version )
+   {
+      wlog( "Ignoring account history saved in an old format in ${f}", ("f", file.generic_string()) );
+      return false;
+   }
+   uint32_t indexed_block_num = 0;
+   fc::raw::unpack( ds, indexed_block_num );
+   if( indexed_block_num < last_applied_block )
+      return false;
+
+   uint64_t next_id = 0;
+   vector<std::pair<uint32_t, uint64_t>> block_first_ids;
+   uint64_t log_size = 0;
+   fc::raw::unpack( ds, next_id );
+   fc::raw::unpack( ds, block_first_ids );
+   fc::raw::unpack( ds, log_size );
+   {
+      std::lock_guard<std::mutex> lock( _log_mutex );
+      _next_id = next_id;
+      _block_first_ids.assign( block_first_ids.begin(), block_first_ids.end() );
+      for( uint64_t i = 0; i < log_size; ++i )
+      {
+         _log.emplace_back();
+         fc::raw::unpack( ds, _log.back() );
+      }
+   }
+
+   // The shard of an account depends on the shard count, which may differ from the one the file was written with
+   uint32_t shard_count = 0;
+   fc::raw::unpack( ds, shard_count );
+   for( uint32_t s = 0; s < shard_count; ++s )
+   {
+      uint64_t accounts = 0;
+      fc::raw::unpack( ds, accounts );
+      for( uint64_t i = 0; i < accounts; ++i )
+      {
+         uint64_t account = 0;
+         vector<uint64_t> ops;
+         fc::raw::unpack( ds, account );
+         fc::raw::unpack( ds, ops );
+         shard_of( account_id_type( account ) ).account_ops[account] = std::move( ops );
+      }
+   }
+
+   _indexed_block_num.store( indexed_block_num );
+   if( indexed_block_num > last_applied_block )
+      rewind_to( last_applied_block + 1 );
+   return true;
+} FC_CAPTURE_AND_RETHROW( (file)(last_applied_block) ) }
+
+optional<operation_history_object> sharded_history_store::find_operation( uint64_t number )const
+{
+   std::lock_guard<std::mutex> lock( _log_mutex );
+   auto itr = std::lower_bound( _log.begin(), _log.end(), number, number_less() );
+   if( itr == _log.end() || itr->id != number )
+      return {};
+   return itr->to_object();
+}
+
+vector<operation_history_object> sharded_history_store::get_account_history( account_id_type account,
+                                                                             operation_history_id_type stop,
+                                                                             unsigned limit,
+                                                                             operation_history_id_type start,
+                                                                             const std::function<bool(const operation_history_object&)>& selector )const
+{
+   FC_ASSERT( limit <= 100 );
+   vector<operation_history_object> result;
+   const shard& s = shard_of( account );
+   std::lock_guard<std::mutex> lock( s.mutex );
+   auto itr = s.account_ops.find( account.instance.value );
+   if( itr == s.account_ops.end() )
+      return result;
+
+   const auto& ops = itr->second;
+   const uint64_t first = stop.instance.value;
+   const uint64_t last = start == operation_history_id_type() ? ops.back() : start.instance.value;
+   for( auto op_itr = ops.rbegin(); op_itr != ops.rend() && *op_itr > first && result.size() < limit; ++op_itr )
+   {
+      if( *op_itr > last )
+         continue;
+      auto op = find_operation( *op_itr );
+      if( op.valid() && selector( *op ) )
+         result.push_back( std::move(*op) );
+   }
+   return result;
+}
+
+vector<operation_history_object> sharded_history_store::get_relative_account_history( account_id_type account,
+                                                                                      uint32_t stop,
+                                                                                      unsigned limit,
+                                                                                      uint32_t start )const
+{
+   FC_ASSERT( limit <= 100 );
+   vector<operation_history_object> result;
+   const shard& s = shard_of( account );
+   std::lock_guard<std::mutex> lock( s.mutex );
+   auto itr = s.account_ops.find( account.instance.value );
+   if( itr == s.account_ops.end() )
+      return result;
+
+   const auto& ops = itr->second;
+   uint64_t sequence = start == 0 ? ops.size() : std::min<uint64_t>( ops.size(), start );
+   for( ; sequence > stop && result.size() < limit; --sequence )
+   {
+      auto op = find_operation( ops[sequence - 1] );
+      if( op.valid() )
+         result.push_back( std::move(*op) );
+   }
+   return result;
+}
+
+} } // graphene::account_history
@@ -27,6 +27,7 @@
 #include <graphene/chain/database.hpp>
 
 #include <graphene/chain/operation_history_object.hpp>
+#include <graphene/account_history/history_store.hpp>
 
 #include <fc/thread/future.hpp>
 
@@ -74,9 +75,16 @@ class account_history_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       virtual void plugin_initialize(const boost::program_options::variables_map& options) override;
       virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
 
       flat_set<account_id_type> tracked_accounts()const;
 
+      /** The store history is indexed into when --history-async-shards is set, nullptr when it lives in the database */
+      const sharded_history_store* async_history()const;
+
+      /** Waits until every applied block is indexed into async_history() */
+      void wait_for_async_history();
+
       friend class detail::account_history_plugin_impl;
       std::unique_ptr<detail::account_history_plugin_impl> my;
 };
@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/impacted_accounts.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+#include <graphene/chain/protocol/compact_operation.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace graphene { namespace account_history {
+   using namespace chain;
+
+   /**
+    * The operations applied in one block, handed from the chain thread to the history pipeline.  Failed operations are
+    * null; they are numbered like the database numbers them but not stored.
+    */
+   struct history_batch
+   {
+      uint32_t                                    block_num = 0;
+      /// Stored but not linked to any account, like the database's collected virtual operations
+      vector<optional<operation_history_object>>  unlinked;
+      vector<optional<operation_history_object>>  operations;
+   };
+
+   /**
+    * @brief Account history kept outside the chain database
+    *
+    * Used by the account_history plugin when history is indexed asynchronously.  Operations are stored once in an
+    * append-only log and numbered exactly like the synchronous plugin numbers the operation_history_objects it
+    * creates, so ids handed out by either mode can be used to page through the other; each account keeps the
+    * numbers of its operations.  Accounts are spread over shards, each with its own lock, so API readers only
+    * contend with the indexer on the shard they read.
+    *
+    * Batches are applied by a single writer.  A batch for a block at or below the last indexed one means the chain
+    * switched forks; everything from that block on is dropped, and its numbers reused, before the batch is indexed.
+    *
+    * The store lives in memory; the plugin saves it on shutdown and loads it back on startup.
+    */
+   class sharded_history_store
+   {
+   public:
+      /**
+       * An operation of the log.  The operation is kept in a compact_operation so that full history does not pay
+       * the size of the largest operation type for every entry.
+       */
+      struct logged_operation
+      {
+         logged_operation() {}
+         logged_operation( const operation_history_object& o, uint64_t number );
+         operation_history_object to_object()const;
+
+         uint64_t            id = 0;
+         compact_operation   op;
+         operation_result    result;
+         uint32_t            block_num = 0;
+         fc::time_point_sec  block_timestamp;
+         uint16_t            trx_in_block = 0;
+         uint16_t            op_in_trx = 0;
+         uint16_t            virtual_op = 0;
+      };
+
+      explicit sharded_history_store( uint32_t shard_count );
+
+      /**
+       * Number the operations of the next batch from next_id on; used to continue the numbering of the database's
+       * operation history index.  Only allowed while the store is empty.
+       */
+      void start_numbering_at( uint64_t next_id );
+
+      /**
+       * Index one block.  impacted_accounts fills the accounts an operation belongs to; only accounts accepted by
+       * is_tracked are recorded.
+       */
+      void apply( history_batch&& batch,
+                  const std::function<void(const operation_history_object&, impacted_accounts_buffer&)>& impacted_accounts,
+                  const std::function<bool(account_id_type)>& is_tracked );
+
+      /** Drop the operations of block_num and every later block */
+      void rewind_to( uint32_t block_num );
+
+      /** Number of the last block whose operations are indexed */
+      uint32_t indexed_block_num()const { return _indexed_block_num.load(); }
+
+      /** Write the whole store to file; must not run concurrently with apply() */
+      void save( const fc::path& file )const;
+
+      /**
+       * Replace the contents of an empty store with the ones saved in file, rewound to last_applied_block.  Returns
+       * false, leaving the store empty, when there is no such file or it does not reach last_applied_block, in which
+       * case the operations of the blocks in between are missing and the store has to be rebuilt by a replay.
+       */
+      bool load( const fc::path& file, uint32_t last_applied_block );
+
+      /** Operations of an account, most recent first, with ids in (stop, start]; start of 0 means the latest */
+      vector<operation_history_object> get_account_history( account_id_type account,
+                                                            operation_history_id_type stop,
+                                                            unsigned limit,
+                                                            operation_history_id_type start,
+                                                            const std::function<bool(const operation_history_object&)>& selector )const;
+
+      /** Operations of an account by its own sequence number, most recent first, in (stop, start]; start of 0 means the latest */
+      vector<operation_history_object> get_relative_account_history( account_id_type account,
+                                                                     uint32_t stop,
+                                                                     unsigned limit,
+                                                                     uint32_t start )const;
+
+   private:
+      struct shard
+      {
+         mutable std::mutex                                      mutex;
+         std::unordered_map<uint64_t, vector<uint64_t>>          account_ops;
+      };
+
+      shard& shard_of( account_id_type account ) { return *_shards[account.instance.value % _shards.size()]; }
+      const shard& shard_of( account_id_type account )const { return *_shards[account.instance.value % _shards.size()]; }
+
+      optional<operation_history_object> find_operation( uint64_t number )const;
+
+      vector<std::unique_ptr<shard>>                 _shards;
+
+      mutable std::mutex                             _log_mutex;
+      std::deque<logged_operation>                   _log;
+      /// Number of the next operation, and the first number used by each block which numbered any operation
+      uint64_t                                       _next_id = 0;
+      std::deque<std::pair<uint32_t, uint64_t>>      _block_first_ids;
+
+      std::atomic<uint32_t>                          _indexed_block_num{0};
+   };
+
+} } // graphene::account_history
+
+FC_REFLECT( graphene::account_history::sharded_history_store::logged_operation,
+            (id)(op)(result)(block_num)(block_timestamp)(trx_in_block)(op_in_trx)(virtual_op) )
@@ -310,8 +310,8 @@ void market_history_plugin::plugin_set_program_options(
 void market_history_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 { try {
    database().applied_block.connect( [&]( const signed_block& b){ my->update_market_histories(b); } );
-   database().add_index< primary_index< bucket_index  > >();
-   database().add_index< primary_index< history_index  > >();
+   database().add_index< primary_index< bucket_index  > >()->use_segmented_undo();
+   database().add_index< primary_index< history_index  > >()->use_segmented_undo();
 
    if( options.count( "bucket-size" ) )
    {
@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/plugin.hpp>
+#include <graphene/chain/database.hpp>
+
+namespace graphene { namespace operation_stream {
+   using namespace chain;
+
+namespace detail
+{
+    class operation_stream_plugin_impl;
+}
+
+/**
+ * @brief Pushes the operations of every applied block to downstream consumers
+ *
+ * Each applied block is written as a frame holding its real and virtual operations, their results and the accounts
+ * they impact, with undo frames when blocks are popped by a fork switch; see stream_writer for the format.  Frames
+ * go to rotating files in --operation-stream-dir and, when --operation-stream-socket is set, to the Unix domain
+ * socket a consumer listens on.  Writing the files is the only work done on the chain thread; the socket is served
+ * by a socket_forwarder.
+ */
+class operation_stream_plugin : public graphene::app::plugin
+{
+   public:
+      operation_stream_plugin();
+      virtual ~operation_stream_plugin();
+
+      std::string plugin_name()const override;
+      virtual void plugin_set_program_options(
+         boost::program_options::options_description& cli,
+         boost::program_options::options_description& cfg) override;
+      virtual void plugin_initialize(const boost::program_options::variables_map& options) override;
+      virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
+
+      friend class detail::operation_stream_plugin_impl;
+      std::unique_ptr<detail::operation_stream_plugin_impl> my;
+};
+
+} } //graphene::operation_stream
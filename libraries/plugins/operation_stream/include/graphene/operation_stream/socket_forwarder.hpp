@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace graphene { namespace operation_stream {
+
+   /**
+    * @brief Sends stream frames to the Unix domain socket of a consumer from a thread of its own
+    *
+    * The chain thread hands over the frames stream_writer::write_block() returned, which wait in a queue of at most
+    * max_queued_blocks entries.  push() never blocks: when the queue is full the frames are left out of it and the
+    * delivery thread reads them back from the segment files once it catches up, so a slow or absent consumer costs
+    * block application nothing but the file writes.
+    *
+    * Whenever the thread (re)connects it first sends the frames after the consumer's checkpoint from the segment
+    * files, as the consumer resumes from its checkpoint.  A failed send closes the connection; connecting is retried
+    * every retry_interval.
+    */
+   class socket_forwarder
+   {
+   public:
+      socket_forwarder( const boost::filesystem::path& dir, const std::string& socket_path, size_t max_queued_blocks,
+                        std::chrono::milliseconds retry_interval = std::chrono::seconds( 1 ) );
+      ~socket_forwarder();
+
+      /** Queue frames already written to the segment files, with sequences first_sequence to last_sequence */
+      void push( std::vector<char>&& frames, uint64_t first_sequence, uint64_t last_sequence );
+
+      /** Sequence of the last frame sent over the current connection */
+      uint64_t sent_sequence()const { return _sent_sequence.load(); }
+
+   private:
+      struct queued_frames
+      {
+         std::vector<char>  bytes;
+         uint64_t           first_sequence = 0;
+         uint64_t           last_sequence = 0;
+      };
+
+      void run();
+      bool connect();
+      bool send( const std::vector<char>& data );
+      void disconnect();
+      /** Send the frames of the segment files after _sent_sequence */
+      bool send_from_files();
+
+      boost::filesystem::path    _dir;
+      std::string                _path;
+      size_t                     _max_queued;
+      std::chrono::milliseconds  _retry_interval;
+
+      std::mutex                 _mutex;
+      std::condition_variable    _wakeup;
+      std::deque<queued_frames>  _queue;
+      /// Last sequence handed to push(), queued or not
+      uint64_t                   _written_sequence = 0;
+      bool                       _stopping = false;
+      int                        _fd = -1;
+
+      std::atomic<uint64_t>      _sent_sequence{0};
+      std::thread                _thread;
+   };
+
+} } // graphene::operation_stream
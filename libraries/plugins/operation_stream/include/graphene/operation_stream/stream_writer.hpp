@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <deque>
+#include <fstream>
+#include <functional>
+
+namespace graphene { namespace operation_stream {
+   using namespace chain;
+
+   /** An operation applied in a block, with its result and the accounts it impacts */
+   struct streamed_operation
+   {
+      operation                  op;
+      operation_result           result;
+      uint16_t                   trx_in_block = 0;
+      uint16_t                   op_in_trx = 0;
+      uint16_t                   virtual_op = 0;
+      bool                       is_virtual = false;
+      flat_set<account_id_type>  impacted;
+   };
+
+   /** The real and virtual operations of an applied block, in the order they were applied */
+   struct block_record
+   {
+      uint32_t                    block_num = 0;
+      block_id_type               block_id;
+      fc::time_point_sec          timestamp;
+      vector<streamed_operation>  operations;
+   };
+
+   /** Tells consumers that a block they were sent has been popped off the chain and must be reverted */
+   struct undo_record
+   {
+      uint32_t       block_num = 0;
+      block_id_type  block_id;
+   };
+
+   typedef fc::static_variant< block_record, undo_record > stream_record;
+
+   /**
+    * One entry of the stream.  Sequence numbers start at 1 and increase by one per frame for the lifetime of the
+    * stream directory, so a consumer checkpoints by remembering the last sequence it processed.
+    */
+   struct stream_frame
+   {
+      uint64_t       sequence = 0;
+      stream_record  record;
+   };
+
+   /**
+    * @brief Append-only operation stream kept in rotating segment files
+    *
+    * Every frame is a little endian uint32 length followed by the packed stream_frame.  A segment file is named
+    * after the sequence of its first frame, zero padded so that names sort in stream order, and a new segment is
+    * started once the current one exceeds the configured size.
+    *
+    * Blocks at or below the last streamed block are either blocks already streamed before a replay, which are
+    * skipped, or the start of a new fork: an undo_record is appended for every streamed block from there on before
+    * the new block.  The writer remembers up to GRAPHENE_MAX_UNDO_HISTORY streamed blocks, recovering them from the
+    * last two segments when it is reopened.
+    *
+    * Consumers may write the last sequence they processed, in decimal, to a file named "checkpoint" in the stream
+    * directory.  Segments made only of frames up to the checkpoint are removed when the writer rotates; without a
+    * checkpoint every segment is kept.
+    */
+   class stream_writer
+   {
+   public:
+      stream_writer( const boost::filesystem::path& dir, uint64_t max_segment_size );
+
+      /**
+       * Append the block, undoing streamed blocks which were forked out first.  Returns the frames which were
+       * appended, each with its length prefix, empty when the block had already been streamed.
+       */
+      vector<char> write_block( const block_record& block );
+
+      /** Sequence of the last frame written, 0 while the stream is empty */
+      uint64_t last_sequence()const { return _last_sequence; }
+
+      /** The last sequence consumers reported in the checkpoint file, 0 when there is none */
+      uint64_t read_checkpoint()const { return read_checkpoint( _dir ); }
+      static uint64_t read_checkpoint( const boost::filesystem::path& dir );
+
+      /**
+       * Call visit with every frame after the given sequence, in stream order, along with its bytes as stored,
+       * length prefix included.  A frame cut short by a crash at the end of the last segment is ignored.
+       */
+      static void read_frames( const boost::filesystem::path& dir, uint64_t after_sequence,
+                               const std::function<void(const stream_frame&, const vector<char>&)>& visit );
+
+   private:
+      static vector<boost::filesystem::path> list_segments( const boost::filesystem::path& dir );
+      static uint64_t segment_first_sequence( const boost::filesystem::path& segment );
+      /** Visit the complete frames of a segment and return the size they take up */
+      static uint64_t read_segment( const boost::filesystem::path& segment, uint64_t after_sequence,
+                                    const std::function<void(const stream_frame&, const vector<char>&)>& visit );
+
+      void recover();
+      void append( const stream_record& record, vector<char>& framed );
+      void open_segment();
+      void remove_consumed_segments();
+
+      boost::filesystem::path                   _dir;
+      uint64_t                                  _max_segment_size;
+      std::ofstream                             _segment;
+      uint64_t                                  _segment_size = 0;
+      uint64_t                                  _last_sequence = 0;
+      /** The streamed blocks which have not been undone, oldest first */
+      std::deque< std::pair<uint32_t, block_id_type> >  _streamed_blocks;
+   };
+
+} } // graphene::operation_stream
+
+FC_REFLECT( graphene::operation_stream::streamed_operation,
+            (op)(result)(trx_in_block)(op_in_trx)(virtual_op)(is_virtual)(impacted) )
+FC_REFLECT( graphene::operation_stream::block_record, (block_num)(block_id)(timestamp)(operations) )
+FC_REFLECT( graphene::operation_stream::undo_record, (block_num)(block_id) )
+FC_REFLECT_TYPENAME( graphene::operation_stream::stream_record )
+FC_REFLECT( graphene::operation_stream::stream_frame, (sequence)(record) )
@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/operation_stream/operation_stream_plugin.hpp>
+#include <graphene/operation_stream/socket_forwarder.hpp>
+#include <graphene/operation_stream/stream_writer.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/config.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/impacted_accounts.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+#ifndef WIN32
+#include <sys/un.h>
+#endif
+
+namespace graphene { namespace operation_stream {
+
+namespace detail
+{
+
+class operation_stream_plugin_impl
+{
+   public:
+      operation_stream_plugin_impl(operation_stream_plugin& _plugin)
+         : _self( _plugin )
+      { }
+
+      /** applied_block callback, streams the operations of the block */
+      void stream_block( const signed_block& b );
+
+      graphene::chain::database& database()
+      {
+         return _self.database();
+      }
+
+      operation_stream_plugin&           _self;
+      boost::filesystem::path            _dir;
+      std::unique_ptr<stream_writer>     _writer;
+      std::unique_ptr<socket_forwarder>  _socket;
+};
+
+void operation_stream_plugin_impl::stream_block( const signed_block& b )
+{
+   block_record record;
+   record.block_num = b.block_num();
+   record.block_id = b.id();
+   record.timestamp = b.timestamp;
+
+   for( const optional< operation_history_object >& o_op : database().get_applied_operations() )
+   {
+      if( !o_op.valid() )
+         continue;
+      const operation_history_object& oho = *o_op;
+
+      streamed_operation op;
+      op.op = oho.op.to_operation();
+      op.result = oho.result;
+      op.trx_in_block = oho.trx_in_block;
+      op.op_in_trx = oho.op_in_trx;
+      op.virtual_op = oho.virtual_op;
+      op.is_virtual = operation_type_limits::is_virtual_operation( oho.op.which() );
+
+      impacted_accounts_buffer impacted;
+      operation_get_history_accounts( op.op, oho.result, impacted );
+      op.impacted.insert( impacted.begin(), impacted.end() );
+
+      record.operations.push_back( std::move(op) );
+   }
+
+   const uint64_t first_sequence = _writer->last_sequence() + 1;
+   auto framed = _writer->write_block( record );
+   if( _socket )
+      _socket->push( std::move(framed), first_sequence, _writer->last_sequence() );
+}
+
+} // end namespace detail
+
+
+operation_stream_plugin::operation_stream_plugin() :
+   my( new detail::operation_stream_plugin_impl(*this) )
+{
+}
+
+operation_stream_plugin::~operation_stream_plugin()
+{
+}
+
+std::string operation_stream_plugin::plugin_name()const
+{
+   return "operation_stream";
+}
+
+void operation_stream_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg
+   )
+{
+   cli.add_options()
+         ("operation-stream-dir", boost::program_options::value<boost::filesystem::path>(),
+          "Directory to write the stream of applied operations to, the stream is disabled when unset")
+         ("operation-stream-segment-size", boost::program_options::value<uint32_t>()->default_value(256),
+          "Size in MiB above which a new operation stream file is started")
+         ("operation-stream-socket", boost::program_options::value<std::string>(),
+          "Unix domain socket of a consumer to push the operation stream to")
+         ("operation-stream-socket-queue", boost::program_options::value<uint32_t>()->default_value(1000),
+          "Number of blocks queued for the socket consumer before they are read back from the stream files instead")
+         ;
+   cfg.add(cli);
+}
+
+void operation_stream_plugin::plugin_initialize(const boost::program_options::variables_map& options)
+{
+   if( !options.count( "operation-stream-dir" ) )
+      return;
+
+   my->_dir = options["operation-stream-dir"].as<boost::filesystem::path>();
+   my->_writer.reset( new stream_writer( my->_dir,
+                                         uint64_t( options["operation-stream-segment-size"].as<uint32_t>() ) * 1024 * 1024 ) );
+   if( options.count( "operation-stream-socket" ) )
+   {
+#ifdef WIN32
+      FC_THROW( "Unix domain sockets are not supported on this platform" );
+#else
+      FC_ASSERT( options["operation-stream-socket"].as<std::string>().size() < sizeof(sockaddr_un::sun_path),
+                 "Operation stream socket path is too long" );
+#endif
+      my->_socket.reset( new socket_forwarder( my->_dir, options["operation-stream-socket"].as<std::string>(),
+                                               options["operation-stream-socket-queue"].as<uint32_t>() ) );
+   }
+
+   database().applied_block.connect( [&]( const signed_block& b){ my->stream_block(b); } );
+}
+
+void operation_stream_plugin::plugin_startup()
+{
+   if( my->_writer )
+      ilog( "Streaming applied operations to ${d}, last sequence ${s}",
+            ("d", my->_dir.string())("s", my->_writer->last_sequence()) );
+}
+
+void operation_stream_plugin::plugin_shutdown()
+{
+   my->_socket.reset();
+}
+
+} }
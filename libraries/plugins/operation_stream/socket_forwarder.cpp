@@ -0,0 +1,234 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <graphene/operation_stream/socket_forwarder.hpp>
+#include <graphene/operation_stream/stream_writer.hpp>
+
+#include <fc/log/logger.hpp>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace graphene { namespace operation_stream {
+
+socket_forwarder::socket_forwarder( const boost::filesystem::path& dir, const std::string& socket_path,
+                                    size_t max_queued_blocks, std::chrono::milliseconds retry_interval )
+   : _dir( dir ),
+     _path( socket_path ),
+     _max_queued( std::max<size_t>( max_queued_blocks, 1 ) ),
+     _retry_interval( retry_interval ),
+     _thread( [this]() { run(); } )
+{
+}
+
+socket_forwarder::~socket_forwarder()
+{
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stopping = true;
+#ifndef WIN32
+      // wakes the delivery thread up from a send() the consumer does not read
+      if( _fd >= 0 )
+         ::shutdown( _fd, SHUT_RDWR );
+#endif
+   }
+   _wakeup.notify_all();
+   _thread.join();
+   disconnect();
+}
+
+void socket_forwarder::push( std::vector<char>&& frames, uint64_t first_sequence, uint64_t last_sequence )
+{
+   if( frames.empty() )
+      return;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _written_sequence = last_sequence;
+      if( _queue.size() < _max_queued )
+      {
+         queued_frames queued;
+         queued.bytes = std::move( frames );
+         queued.first_sequence = first_sequence;
+         queued.last_sequence = last_sequence;
+         _queue.push_back( std::move( queued ) );
+      }
+   }
+   _wakeup.notify_one();
+}
+
+void socket_forwarder::run()
+{
+   bool connected = false;
+   while( true )
+   {
+      if( !connected )
+      {
+         {
+            std::unique_lock<std::mutex> lock( _mutex );
+            if( _stopping )
+               return;
+         }
+         if( !connect() )
+         {
+            std::unique_lock<std::mutex> lock( _mutex );
+            _wakeup.wait_for( lock, _retry_interval, [this]() { return _stopping; } );
+            continue;
+         }
+         connected = true;
+         _sent_sequence.store( stream_writer::read_checkpoint( _dir ) );
+         ilog( "Operation stream consumer connected, replaying from sequence ${s}", ("s", _sent_sequence.load() + 1) );
+         if( !send_from_files() )
+         {
+            wlog( "Operation stream consumer disconnected during replay" );
+            disconnect();
+            connected = false;
+            std::unique_lock<std::mutex> lock( _mutex );
+            _wakeup.wait_for( lock, _retry_interval, [this]() { return _stopping; } );
+         }
+         continue;
+      }
+
+      queued_frames next;
+      uint64_t written;
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         _wakeup.wait( lock, [this]() {
+            return _stopping || !_queue.empty() || _sent_sequence.load() < _written_sequence;
+         });
+         if( _stopping )
+            return;
+         if( !_queue.empty() )
+         {
+            next = std::move( _queue.front() );
+            _queue.pop_front();
+         }
+         written = _written_sequence;
+      }
+
+      bool ok = true;
+      if( !next.bytes.empty() && next.first_sequence == _sent_sequence.load() + 1 )
+      {
+         ok = send( next.bytes );
+         if( ok )
+            _sent_sequence.store( next.last_sequence );
+      }
+      else
+      {
+         // Frames were left out of the full queue or replayed already; the files hold every frame pushed so far
+         const uint64_t target = next.bytes.empty() ? written : next.last_sequence;
+         if( target > _sent_sequence.load() )
+            ok = send_from_files() && _sent_sequence.load() >= target;
+      }
+      if( !ok )
+      {
+         wlog( "Operation stream consumer disconnected at sequence ${s}", ("s", _sent_sequence.load()) );
+         disconnect();
+         connected = false;
+         std::unique_lock<std::mutex> lock( _mutex );
+         _wakeup.wait_for( lock, _retry_interval, [this]() { return _stopping; } );
+      }
+   }
+}
+
+bool socket_forwarder::send_from_files()
+{
+   bool ok = true;
+   stream_writer::read_frames( _dir, _sent_sequence.load(), [&]( const stream_frame& frame, const std::vector<char>& bytes ) {
+      if( ok && frame.sequence == _sent_sequence.load() + 1 )
+      {
+         ok = send( bytes );
+         if( ok )
+            _sent_sequence.store( frame.sequence );
+      }
+   });
+   return ok;
+}
+
+#ifndef WIN32
+bool socket_forwarder::connect()
+{
+   sockaddr_un addr;
+   std::memset( &addr, 0, sizeof(addr) );
+   addr.sun_family = AF_UNIX;
+   if( _path.size() >= sizeof(addr.sun_path) )
+      return false;
+   std::strncpy( addr.sun_path, _path.c_str(), sizeof(addr.sun_path) - 1 );
+
+   const int fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+   if( fd < 0 )
+      return false;
+   if( ::connect( fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr) ) != 0 )
+   {
+      ::close( fd );
+      return false;
+   }
+#ifdef SO_NOSIGPIPE
+   int on = 1;
+   ::setsockopt( fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on) );
+#endif
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   _fd = fd;
+   if( _stopping )
+      ::shutdown( _fd, SHUT_RDWR );
+   return true;
+}
+
+bool socket_forwarder::send( const std::vector<char>& data )
+{
+#ifdef MSG_NOSIGNAL
+   const int flags = MSG_NOSIGNAL;
+#else
+   const int flags = 0;
+#endif
+   size_t sent = 0;
+   while( sent < data.size() )
+   {
+      const auto n = ::send( _fd, data.data() + sent, data.size() - sent, flags );
+      if( n <= 0 )
+         return false;
+      sent += n;
+   }
+   return true;
+}
+
+void socket_forwarder::disconnect()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( _fd >= 0 )
+      ::close( _fd );
+   _fd = -1;
+}
+#else
+bool socket_forwarder::connect() { return false; }
+bool socket_forwarder::send( const std::vector<char>& ) { return false; }
+void socket_forwarder::disconnect() {}
+#endif
+
+} } // graphene::operation_stream
@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/operation_stream/stream_writer.hpp>
+
+#include <graphene/chain/config.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace operation_stream {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+   const char* const segment_extension = ".ops";
+
+   void append_length( vector<char>& out, uint32_t length )
+   {
+      for( int i = 0; i < 4; ++i )
+         out.push_back( char( ( length >> ( 8 * i ) ) & 0xff ) );
+   }
+
+   uint32_t read_length( const char* in )
+   {
+      uint32_t length = 0;
+      for( int i = 0; i < 4; ++i )
+         length |= uint32_t( uint8_t( in[i] ) ) << ( 8 * i );
+      return length;
+   }
+}
+
+stream_writer::stream_writer( const bfs::path& dir, uint64_t max_segment_size )
+   : _dir( dir ), _max_segment_size( std::max<uint64_t>( max_segment_size, 1 ) )
+{
+   bfs::create_directories( _dir );
+   recover();
+}
+
+vector<bfs::path> stream_writer::list_segments( const bfs::path& dir )
+{
+   vector<bfs::path> result;
+   if( !bfs::exists( dir ) )
+      return result;
+   for( bfs::directory_iterator itr( dir ); itr != bfs::directory_iterator(); ++itr )
+      if( bfs::is_regular_file( itr->path() ) && itr->path().extension() == segment_extension )
+         result.push_back( itr->path() );
+   std::sort( result.begin(), result.end() );
+   return result;
+}
+
+uint64_t stream_writer::segment_first_sequence( const bfs::path& segment )
+{
+   return std::stoull( segment.stem().string() );
+}
+
+uint64_t stream_writer::read_segment( const bfs::path& segment, uint64_t after_sequence,
+                                      const std::function<void(const stream_frame&, const vector<char>&)>& visit )
+{
+   std::ifstream in( segment.string(), std::ios::binary );
+   FC_ASSERT( in, "Unable to open operation stream segment ${f}", ("f", segment.string()) );
+   vector<char> data( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+
+   uint64_t pos = 0;
+   vector<char> framed;
+   while( data.size() - pos >= 4 )
+   {
+      const uint32_t length = read_length( data.data() + pos );
+      if( data.size() - pos - 4 < length )
+         break;
+      framed.assign( data.begin() + pos, data.begin() + pos + 4 + length );
+      fc::datastream<const char*> ds( framed.data() + 4, length );
+      stream_frame frame;
+      fc::raw::unpack( ds, frame );
+      if( frame.sequence > after_sequence )
+         visit( frame, framed );
+      pos += 4 + length;
+   }
+   return pos;
+}
+
+void stream_writer::read_frames( const bfs::path& dir, uint64_t after_sequence,
+                                 const std::function<void(const stream_frame&, const vector<char>&)>& visit )
+{
+   const auto segments = list_segments( dir );
+   for( size_t i = 0; i < segments.size(); ++i )
+   {
+      // every frame of this segment comes before the next segment's first one
+      if( i + 1 < segments.size() && segment_first_sequence( segments[i+1] ) <= after_sequence + 1 )
+         continue;
+      read_segment( segments[i], after_sequence, visit );
+   }
+}
+
+uint64_t stream_writer::read_checkpoint( const bfs::path& dir )
+{
+   const auto checkpoint = dir / "checkpoint";
+   if( !bfs::exists( checkpoint ) )
+      return 0;
+   std::ifstream in( checkpoint.string() );
+   uint64_t sequence = 0;
+   if( !( in >> sequence ) )
+      return 0;
+   return sequence;
+}
+
+void stream_writer::recover()
+{
+   const auto segments = list_segments( _dir );
+   if( segments.empty() )
+      return;
+
+   const auto remember = [this]( const stream_frame& frame, const vector<char>& ) {
+      _last_sequence = frame.sequence;
+      if( frame.record.which() == stream_record::tag<block_record>::value )
+      {
+         const auto& block = frame.record.get<block_record>();
+         _streamed_blocks.emplace_back( block.block_num, block.block_id );
+         if( _streamed_blocks.size() > GRAPHENE_MAX_UNDO_HISTORY )
+            _streamed_blocks.pop_front();
+      }
+      else if( !_streamed_blocks.empty() )
+         _streamed_blocks.pop_back();
+   };
+
+   // the previous segment as well, in case the last one was started just before the node stopped
+   if( segments.size() > 1 )
+      read_segment( segments[segments.size() - 2], 0, remember );
+   const auto& last = segments.back();
+   _last_sequence = segment_first_sequence( last ) - 1;
+   const uint64_t valid_size = read_segment( last, 0, remember );
+
+   // drop a frame left incomplete when the node stopped while writing it
+   if( valid_size < bfs::file_size( last ) )
+   {
+      wlog( "Truncating incomplete frame at the end of operation stream segment ${f}", ("f", last.string()) );
+      bfs::resize_file( last, valid_size );
+   }
+
+   _segment.open( last.string(), std::ios::binary | std::ios::app );
+   FC_ASSERT( _segment, "Unable to open operation stream segment ${f}", ("f", last.string()) );
+   _segment_size = valid_size;
+}
+
+void stream_writer::open_segment()
+{
+   if( _segment.is_open() )
+      _segment.close();
+
+   string name = std::to_string( _last_sequence + 1 );
+   name.insert( 0, 20 - name.size(), '0' );
+   const auto path = _dir / ( name + segment_extension );
+   _segment.open( path.string(), std::ios::binary | std::ios::trunc );
+   FC_ASSERT( _segment, "Unable to create operation stream segment ${f}", ("f", path.string()) );
+   _segment_size = 0;
+
+   remove_consumed_segments();
+}
+
+void stream_writer::remove_consumed_segments()
+{
+   const uint64_t checkpoint = read_checkpoint();
+   if( checkpoint == 0 )
+      return;
+   const auto segments = list_segments( _dir );
+   for( size_t i = 0; i + 1 < segments.size(); ++i )
+   {
+      if( segment_first_sequence( segments[i+1] ) > checkpoint + 1 )
+         break;
+      bfs::remove( segments[i] );
+   }
+}
+
+void stream_writer::append( const stream_record& record, vector<char>& framed )
+{
+   stream_frame frame;
+   frame.sequence = _last_sequence + 1;
+   frame.record = record;
+   const auto packed = fc::raw::pack( frame );
+
+   const size_t start = framed.size();
+   append_length( framed, packed.size() );
+   framed.insert( framed.end(), packed.begin(), packed.end() );
+
+   _segment.write( framed.data() + start, framed.size() - start );
+   FC_ASSERT( _segment, "Failed to write to the operation stream" );
+   _segment_size += framed.size() - start;
+   _last_sequence = frame.sequence;
+}
+
+vector<char> stream_writer::write_block( const block_record& block )
+{
+   vector<char> framed;
+   if( !_streamed_blocks.empty() && block.block_num <= _streamed_blocks.back().first )
+   {
+      // older than anything a fork could reach, so it is being replayed
+      if( block.block_num < _streamed_blocks.front().first )
+         return framed;
+      auto itr = std::find_if( _streamed_blocks.begin(), _streamed_blocks.end(),
+                               [&block]( const std::pair<uint32_t, block_id_type>& b ) { return b.first == block.block_num; } );
+      if( itr != _streamed_blocks.end() && itr->second == block.block_id )
+         return framed;
+   }
+
+   if( !_segment.is_open() || _segment_size >= _max_segment_size )
+      open_segment();
+
+   while( !_streamed_blocks.empty() && _streamed_blocks.back().first >= block.block_num )
+   {
+      undo_record undo;
+      undo.block_num = _streamed_blocks.back().first;
+      undo.block_id = _streamed_blocks.back().second;
+      append( undo, framed );
+      _streamed_blocks.pop_back();
+   }
+
+   append( block, framed );
+   _streamed_blocks.emplace_back( block.block_num, block.block_id );
+   if( _streamed_blocks.size() > GRAPHENE_MAX_UNDO_HISTORY )
+      _streamed_blocks.pop_front();
+
+   _segment.flush();
+   return framed;
+}
+
+} } // graphene::operation_stream
@@ -86,6 +86,7 @@ private:
    std::map<chain::public_key_type, fc::ecc::private_key> _private_keys;
    std::set<chain::witness_id_type> _witnesses;
    fc::future<void> _block_production_task;
+   fc::microseconds _production_time_budget = fc::milliseconds( 250 );
 };
 
 } } //graphene::witness_plugin
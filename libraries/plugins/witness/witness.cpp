@@ -75,6 +75,8 @@ void witness_plugin::plugin_set_program_options(
          ("private-key", bpo::value<vector<string>>()->composing()->multitoken()->
           DEFAULT_VALUE_VECTOR(std::make_pair(chain::public_key_type(default_priv_key.get_public_key()), graphene::utilities::key_to_wif(default_priv_key))),
           "Tuple of [PublicKey, WIF private key] (may specify multiple times)")
+         ("block-production-time-budget", bpo::value<uint32_t>()->default_value(250),
+          "Milliseconds a witness may spend applying pending transactions when producing a block, 0 for no limit")
          ;
    config_file_options.add(command_line_options);
 }
@@ -90,6 +92,9 @@ void witness_plugin::plugin_initialize(const boost::program_options::variables_m
    _options = &options;
    LOAD_VALUE_SET(options, "witness-id", _witnesses, chain::witness_id_type)
 
+   if( options.count("block-production-time-budget") )
+      _production_time_budget = fc::milliseconds( options["block-production-time-budget"].as<uint32_t>() );
+
    if( options.count("private-key") )
    {
       const std::vector<std::string> key_id_to_wif_pair_strings = options["private-key"].as<std::vector<std::string>>();
@@ -127,6 +132,7 @@ void witness_plugin::plugin_startup()
    if( !_witnesses.empty() )
    {
       ilog("Launching block production for ${n} witnesses.", ("n", _witnesses.size()));
+      d.node_properties().block_production_time_budget = _production_time_budget;
       app().set_block_production(true);
       if( _production_enabled )
       {
@@ -287,7 +293,14 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
       _production_skip_flags
       );
    capture("n", block.block_num())("t", block.timestamp)("c", now);
-   fc::async( [this,block](){ p2p_node().broadcast(net::block_message(block)); } );
+   fc::async( [this,block](){
+      p2p_node().broadcast(net::block_message(block));
+      // negative when the block went out before its scheduled time
+      const fc::microseconds latency = graphene::time::now() - fc::time_point(block.timestamp);
+      database().record_block_broadcast_latency( latency );
+      ilog("Broadcast block #${n} ${l} ms after the start of its slot",
+           ("n", block.block_num())("l", latency.count() / 1000));
+   } );
 
    return block_production_condition::produced;
 }
@@ -0,0 +1,476 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Replays a range of blocks into two databases side by side, one applying the blocks the way a node replays them
+ * and one under an experimental mode, and checks that both end up in the same state.
+ *
+ * After every block the applied (and virtual) operation streams of both sides are compared, and every
+ * checkpoint-interval blocks a digest of every object index. When the state of both sides diverges within a checkpoint
+ * interval, the blocks are replayed once more on fresh databases comparing the state after every block of that
+ * interval. On the first divergence the offending operations or objects of both sides are printed.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+#include <graphene/chain/protocol/protocol.hpp>
+#include <graphene/chain/transaction_object.hpp>
+#include <graphene/egenesis/egenesis.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+using namespace graphene::chain;
+using namespace std;
+namespace bpo = boost::program_options;
+
+namespace {
+
+enum class replay_mode
+{
+   reindex,    ///< apply_block() with undo disabled and the reindex skip flags, as a replaying node does
+   push,       ///< push_block() with undo sessions and the fork database, same skip flags
+   validate,   ///< push_block() with full validation
+   reload      ///< as reindex, but the object database is saved and loaded again every reload-interval blocks
+};
+
+replay_mode parse_mode( const string& name )
+{
+   if( name == "reindex" )  return replay_mode::reindex;
+   if( name == "push" )     return replay_mode::push;
+   if( name == "validate" ) return replay_mode::validate;
+   if( name == "reload" )   return replay_mode::reload;
+   FC_THROW( "Unknown replay mode ${m}", ("m", name) );
+}
+
+// The skip flags database::reindex() uses:
+const uint32_t reindex_skip = database::skip_witness_signature |
+                              database::skip_transaction_signatures |
+                              database::skip_transaction_dupe_check |
+                              database::skip_tapos_check |
+                              database::skip_witness_schedule_check |
+                              database::skip_authority_check;
+
+/// One database being replayed, with the operations applied by its last block.
+class replay_side
+{
+   public:
+      replay_side( const string& name, replay_mode mode, const fc::path& data_dir,
+                   std::function<genesis_state_type()> genesis_loader, uint32_t reload_interval )
+         : name( name ), _mode( mode ), _data_dir( data_dir ), _genesis_loader( genesis_loader ),
+           _reload_interval( reload_interval )
+      {}
+
+      void open()
+      {
+         _db.reset( new database );
+         _db->applied_block.connect( [this]( const signed_block& ) { capture_applied_operations(); } );
+         _db->open( _data_dir, _genesis_loader, "replay_validator" );
+         if( _mode == replay_mode::reindex || _mode == replay_mode::reload )
+            _db->_undo_db.disable();
+      }
+
+      void close()
+      {
+         _db->close( false );
+      }
+
+      const database& db()const { return *_db; }
+
+      /// @return an empty string on success, the error otherwise
+      string apply( const signed_block& block )
+      {
+         ops.clear();
+         ops_digest = fc::sha256();
+         auto start = fc::time_point::now();
+         try
+         {
+            switch( _mode )
+            {
+               case replay_mode::reindex:
+               case replay_mode::reload:
+                  _db->apply_block( block, reindex_skip );
+                  break;
+               case replay_mode::push:
+                  _db->push_block( block, reindex_skip );
+                  break;
+               case replay_mode::validate:
+                  _db->push_block( block, database::skip_nothing );
+                  break;
+            }
+            apply_time += fc::time_point::now() - start;
+
+            // Objects are loaded back into a fresh database, as on a node restart:
+            if( _mode == replay_mode::reload && block.block_num() % _reload_interval == 0 )
+            {
+               close();
+               open();
+            }
+         }
+         catch( const fc::exception& e )
+         {
+            return e.to_detail_string();
+         }
+         return string();
+      }
+
+      const string                     name;
+      vector<operation_history_object> ops;
+      fc::sha256                       ops_digest;
+      uint32_t                         virtual_ops = 0;
+      fc::microseconds                 apply_time;
+
+   private:
+      void capture_applied_operations()
+      {
+         fc::sha256::encoder enc;
+         for( const auto& oho : _db->get_applied_operations() )
+         {
+            if( !oho.valid() )
+               continue;
+            fc::raw::pack( enc, *oho );
+            ops.push_back( *oho );
+            if( operation_type_limits::is_virtual_operation( oho->op.which() ) )
+               ++virtual_ops;
+         }
+         ops_digest = enc.result();
+      }
+
+      std::unique_ptr<database>           _db;
+      replay_mode                         _mode;
+      fc::path                            _data_dir;
+      std::function<genesis_state_type()> _genesis_loader;
+      uint32_t                            _reload_interval;
+};
+
+struct index_state
+{
+   size_t     count = 0;
+   fc::sha256 digest;
+};
+
+typedef std::pair<uint8_t, uint8_t> index_key;
+
+std::map<index_key, index_state> digest_state( const database& db, const set<index_key>& ignored )
+{
+   std::map<index_key, index_state> result;
+   for( uint32_t space = 0; space < 0xff; ++space )
+      for( uint32_t type = 0; type < 0xff; ++type )
+      {
+         const index* idx = db.find_index( space, type );
+         if( idx == nullptr || ignored.count( index_key( space, type ) ) )
+            continue;
+         index_state& state = result[index_key( space, type )];
+         fc::sha256::encoder enc;
+         idx->inspect_all_objects( [&]( const object& o ) {
+            const auto packed = o.pack();
+            enc.write( packed.data(), packed.size() );
+            ++state.count;
+         } );
+         state.digest = enc.result();
+      }
+   return result;
+}
+
+std::map<object_id_type, const object*> collect_objects( const database& db, index_key key )
+{
+   std::map<object_id_type, const object*> result;
+   db.get_index( key.first, key.second ).inspect_all_objects( [&]( const object& o ) { result[o.id] = &o; } );
+   return result;
+}
+
+string to_json( const object* o )
+{
+   return o == nullptr ? string( "(missing)" ) : fc::json::to_pretty_string( o->to_variant() );
+}
+
+bool same_states( const replay_side& a, const replay_side& b, const set<index_key>& ignored )
+{
+   const auto state_a = digest_state( a.db(), ignored );
+   const auto state_b = digest_state( b.db(), ignored );
+   return state_a.size() == state_b.size() &&
+          std::equal( state_a.begin(), state_a.end(), state_b.begin(),
+                      []( const std::pair<const index_key, index_state>& x, const std::pair<const index_key, index_state>& y ) {
+                         return x.first == y.first && x.second.digest == y.second.digest;
+                      } );
+}
+
+/// Print the objects which differ between both sides, for every index whose digest differs.
+bool compare_states( const replay_side& a, const replay_side& b, const set<index_key>& ignored, uint32_t max_diff )
+{
+   const auto state_a = digest_state( a.db(), ignored );
+   const auto state_b = digest_state( b.db(), ignored );
+   bool identical = true;
+
+   for( const auto& item : state_a )
+   {
+      const auto& other = state_b.at( item.first );
+      if( item.second.digest == other.digest )
+         continue;
+      identical = false;
+
+      std::cout << "Index " << int(item.first.first) << "." << int(item.first.second) << " differs: "
+                << item.second.count << " objects in " << a.name << ", " << other.count << " in " << b.name << "\n";
+
+      auto objects_a = collect_objects( a.db(), item.first );
+      auto objects_b = collect_objects( b.db(), item.first );
+      set<object_id_type> ids;
+      for( const auto& o : objects_a ) ids.insert( o.first );
+      for( const auto& o : objects_b ) ids.insert( o.first );
+
+      uint32_t printed = 0;
+      for( const auto& id : ids )
+      {
+         const object* oa = objects_a.count( id ) ? objects_a[id] : nullptr;
+         const object* ob = objects_b.count( id ) ? objects_b[id] : nullptr;
+         if( oa != nullptr && ob != nullptr && oa->pack() == ob->pack() )
+            continue;
+         if( printed++ == max_diff )
+         {
+            std::cout << "   ...\n";
+            break;
+         }
+         std::cout << "   " << string( id ) << "\n"
+                   << "   " << a.name << ": " << to_json( oa ) << "\n"
+                   << "   " << b.name << ": " << to_json( ob ) << "\n";
+      }
+   }
+   return identical;
+}
+
+void print_operations( const replay_side& a, const replay_side& b, uint32_t max_diff )
+{
+   std::cout << a.name << " applied " << a.ops.size() << " operations, " << b.name << " " << b.ops.size() << "\n";
+   uint32_t printed = 0;
+   for( size_t i = 0; i < std::max( a.ops.size(), b.ops.size() ) && printed < max_diff; ++i )
+   {
+      const auto va = i < a.ops.size() ? fc::json::to_pretty_string( a.ops[i] ) : string( "(missing)" );
+      const auto vb = i < b.ops.size() ? fc::json::to_pretty_string( b.ops[i] ) : string( "(missing)" );
+      if( va == vb )
+         continue;
+      ++printed;
+      std::cout << "   operation " << i << "\n"
+                << "   " << a.name << ": " << va << "\n"
+                << "   " << b.name << ": " << vb << "\n";
+   }
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("Graphene replay validator");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("blockchain-dir,b", bpo::value<boost::filesystem::path>()->default_value("witness_node_data_dir/blockchain"), "Blockchain directory of a node to read the blocks from")
+            ("data-dir,d", bpo::value<boost::filesystem::path>()->default_value("replay_validator_data_dir"), "Directory for the databases of both sides, wiped on start")
+            ("genesis-json,g", bpo::value<boost::filesystem::path>(), "File to read genesis state from (default: embedded genesis)")
+            ("mode,m", bpo::value<string>()->default_value("push"), "Experimental mode: push, validate, reload or reindex")
+            ("baseline-mode", bpo::value<string>()->default_value("reindex"), "Mode of the reference side")
+            ("stop,s", bpo::value<uint32_t>()->default_value(0), "Last block to replay (0=last block available)")
+            ("checkpoint-interval,c", bpo::value<uint32_t>()->default_value(1000), "Number of blocks between state comparisons")
+            ("reload-interval", bpo::value<uint32_t>()->default_value(10000), "Number of blocks between reloads in reload mode")
+            ("ignore-index", bpo::value<vector<string>>()->composing(), "Index to leave out of the state comparison, as space.type (repeatable)")
+            ("max-diff", bpo::value<uint32_t>()->default_value(20), "Maximal number of differing objects or operations printed")
+            ("parallel,p", "Apply each block to both sides on separate threads")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         boost::program_options::store( boost::program_options::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const boost::program_options::error& e)
+      {
+         std::cerr << "replay_validator:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 0;
+      }
+
+      auto absolute = []( fc::path p ) { return p.is_relative() ? fc::current_path() / p : p; };
+      const fc::path blockchain_dir = absolute( options["blockchain-dir"].as<boost::filesystem::path>() );
+      const fc::path data_dir = absolute( options["data-dir"].as<boost::filesystem::path>() );
+
+      std::string genesis_str;
+      if( options.count("genesis-json") )
+         fc::read_file_contents( options["genesis-json"].as<boost::filesystem::path>(), genesis_str );
+      else
+         graphene::egenesis::compute_egenesis_json( genesis_str );
+      auto genesis_loader = [&genesis_str]() {
+         auto genesis = fc::json::from_string( genesis_str ).as<genesis_state_type>();
+         genesis.initial_chain_id = fc::sha256::hash( genesis_str );
+         return genesis;
+      };
+
+      // Transaction objects only exist when the duplicate check is not skipped, so they differ between modes
+      // with different skip flags by design:
+      set<index_key> ignored = { index_key( transaction_object::space_id, transaction_object::type_id ) };
+      if( options.count("ignore-index") )
+         for( const auto& s : options["ignore-index"].as<vector<string>>() )
+         {
+            auto dot = s.find('.');
+            FC_ASSERT( dot != string::npos, "Expected space.type, got ${s}", ("s", s) );
+            ignored.insert( index_key( fc::to_uint64( s.substr( 0, dot ) ), fc::to_uint64( s.substr( dot + 1 ) ) ) );
+         }
+
+      block_database blocks;
+      FC_ASSERT( fc::exists( blockchain_dir / "database" / "block_num_to_block" ),
+                 "No block database in ${d}", ("d", blockchain_dir.preferred_string()) );
+      blocks.open( blockchain_dir / "database" / "block_num_to_block" );
+      const auto last_block = blocks.last();
+      FC_ASSERT( last_block.valid(), "The block database is empty" );
+      uint32_t stop = options["stop"].as<uint32_t>();
+      if( stop == 0 || stop > last_block->block_num() )
+         stop = last_block->block_num();
+
+      const uint32_t checkpoint_interval = std::max( options["checkpoint-interval"].as<uint32_t>(), 1u );
+      const uint32_t reload_interval = std::max( options["reload-interval"].as<uint32_t>(), 1u );
+      const uint32_t max_diff = options["max-diff"].as<uint32_t>();
+      const bool parallel = options.count("parallel") != 0;
+
+      const replay_mode baseline_mode = parse_mode( options["baseline-mode"].as<string>() );
+      const replay_mode experimental_mode = parse_mode( options["mode"].as<string>() );
+
+      // Replays blocks 1 to last on fresh databases, comparing the state every checkpoint interval and after every
+      // block from exact_from to exact_to. Returns 0 when both sides stay identical, 2 when the blocks or the
+      // applied operations diverge and 3 when the state does, along with the blocks it diverged between.
+      auto replay = [&]( uint32_t last, uint32_t exact_from, uint32_t exact_to,
+                         uint32_t& diverged_from, uint32_t& diverged_at ) -> int
+      {
+         fc::remove_all( data_dir );
+         replay_side baseline( "baseline", baseline_mode, data_dir / "baseline", genesis_loader, reload_interval );
+         replay_side experimental( "experimental", experimental_mode, data_dir / "experimental", genesis_loader,
+                                   reload_interval );
+         baseline.open();
+         experimental.open();
+
+         uint32_t last_good_checkpoint = 0;
+         for( uint32_t num = 1; num <= last; ++num )
+         {
+            const auto block = blocks.fetch_by_number( num );
+            FC_ASSERT( block.valid(), "Block ${n} is missing from the block database", ("n", num) );
+
+            string baseline_error, experimental_error;
+            if( parallel )
+            {
+               std::thread worker( [&]() { experimental_error = experimental.apply( *block ); } );
+               baseline_error = baseline.apply( *block );
+               worker.join();
+            }
+            else
+            {
+               baseline_error = baseline.apply( *block );
+               experimental_error = experimental.apply( *block );
+            }
+
+            if( !baseline_error.empty() || !experimental_error.empty() )
+            {
+               std::cout << "Block " << num << " failed to apply\n"
+                         << "   baseline: " << ( baseline_error.empty() ? string( "ok" ) : baseline_error ) << "\n"
+                         << "   experimental: " << ( experimental_error.empty() ? string( "ok" ) : experimental_error ) << "\n";
+               return 2;
+            }
+
+            if( baseline.ops_digest != experimental.ops_digest )
+            {
+               std::cout << "Block " << num << " is the first block with diverging applied operations\n";
+               print_operations( baseline, experimental, max_diff );
+               return 2;
+            }
+
+            const bool exact = num >= exact_from && num <= exact_to;
+            if( exact || num % checkpoint_interval == 0 || num == last )
+            {
+               if( !same_states( baseline, experimental, ignored ) )
+               {
+                  diverged_from = exact ? num : last_good_checkpoint + 1;
+                  diverged_at = num;
+                  if( diverged_from == diverged_at )
+                  {
+                     std::cout << "Block " << num << " is the first block with diverging state\n";
+                     compare_states( baseline, experimental, ignored, max_diff );
+                  }
+                  return 3;
+               }
+               last_good_checkpoint = num;
+               std::cerr << "\rblock #" << num << " of " << last << " identical";
+            }
+         }
+
+         std::cerr << "\n";
+         std::cout << "Replayed " << last << " blocks, both sides identical\n"
+                   << "   baseline: " << baseline.apply_time.count() / 1000 << " ms, "
+                   << baseline.virtual_ops << " virtual operations\n"
+                   << "   experimental: " << experimental.apply_time.count() / 1000 << " ms, "
+                   << experimental.virtual_ops << " virtual operations\n";
+
+         baseline.close();
+         experimental.close();
+         return 0;
+      };
+
+      uint32_t diverged_from = 0, diverged_at = 0;
+      int result = replay( stop, 0, 0, diverged_from, diverged_at );
+      if( result == 3 && diverged_from != diverged_at )
+      {
+         std::cerr << "\n";
+         std::cout << "State diverged between block " << diverged_from << " and block " << diverged_at
+                   << ", replaying again to find the first divergent block\n";
+         const uint32_t interval_end = diverged_at;
+         result = replay( interval_end, diverged_from, interval_end, diverged_from, diverged_at );
+         if( result == 0 )
+            std::cout << "The state did not diverge up to block " << interval_end
+                      << " the second time, the divergence is not deterministic\n";
+         return 2;
+      }
+      if( result != 0 )
+         return 2;
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cout << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
@@ -27,6 +27,8 @@
 #include <fc/variant.hpp>
 #include <fc/variant_object.hpp>
 
+#include <graphene/chain/operation_history_object.hpp>
+#include <graphene/chain/protocol/compact_operation.hpp>
 #include <graphene/chain/protocol/protocol.hpp>
 
 #include <algorithm>
@@ -60,6 +62,7 @@ struct size_check_type_visitor
       vo["name"] = fc::get_typename<Type>::name();
       vo["mem_size"] = sizeof( Type );
       vo["wire_size"] = get_wire_size<Type>();
+      vo["inline_in_compact_operation"] = compact_operation::is_inline<Type>::value;
       g_op_types.push_back( vo );
    }
 };
@@ -106,6 +109,11 @@ int main( int argc, char** argv )
       }
       std::cout << "]\n";
       std::cerr << "Size of block header: " << sizeof( block_header ) << " " << fc::raw::pack_size( block_header() ) << "\n";
+      // Every out of line operation additionally takes its own operation and a shared_ptr control block:
+      std::cerr << "Size of operation: " << sizeof( operation )
+                << ", compact_operation: " << sizeof( compact_operation )
+                << " (inline variant " << sizeof( compact_operation::inline_operation ) << ")\n";
+      std::cerr << "Size of operation_history_object: " << sizeof( operation_history_object ) << "\n";
    }
    catch ( const fc::exception& e ){ edump((e.to_detail_string())); }
    idump((sizeof(signed_block)));
@@ -26,6 +26,7 @@
 #include <graphene/witness/witness.hpp>
 #include <graphene/account_history/account_history_plugin.hpp>
 #include <graphene/market_history/market_history_plugin.hpp>
+#include <graphene/operation_stream/operation_stream_plugin.hpp>
 
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/utilities/git_revision.hpp>
@@ -79,6 +80,7 @@ int main(int argc, char** argv) {
       auto witness_plug = node->register_plugin<witness_plugin::witness_plugin>();
       auto history_plug = node->register_plugin<account_history::account_history_plugin>();
       auto market_history_plug = node->register_plugin<market_history::market_history_plugin>();
+      auto operation_stream_plug = node->register_plugin<operation_stream::operation_stream_plugin>();
 
       try
       {
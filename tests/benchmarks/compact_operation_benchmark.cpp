@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/protocol/compact_operation.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+using namespace graphene::chain;
+
+BOOST_AUTO_TEST_SUITE( compact_operation_benchmarks )
+
+BOOST_AUTO_TEST_CASE( compact_operation_history_benchmark )
+{ try {
+#ifdef NDEBUG
+   const uint32_t rounds = 200;
+#else
+   const uint32_t rounds = 20;
+#endif
+   const uint32_t count = 10000;
+
+   // Mostly transfers and fills, as in the history of a busy node, with an occasional account update:
+   vector<operation> ops;
+   ops.reserve( count );
+   for( uint32_t i = 0; i < count; ++i )
+   {
+      if( i % 16 == 0 )
+         ops.emplace_back( account_update_operation() );
+      else if( i % 2 )
+         ops.emplace_back( transfer_operation() );
+      else
+         ops.emplace_back( fill_order_operation() );
+   }
+   const vector<compact_operation> compact( ops.begin(), ops.end() );
+
+   size_t checksum = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      const vector<operation> copy( ops );
+      checksum += copy.back().which();
+   }
+   const auto operation_time = fc::time_point::now() - start;
+
+   size_t compact_checksum = 0;
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      const vector<compact_operation> copy( compact );
+      compact_checksum += copy.back().which();
+   }
+   const auto compact_time = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( checksum, compact_checksum );
+   BOOST_CHECK_LT( sizeof(compact_operation), sizeof(operation) );
+
+   ilog( "history of ${n} operations: operation ${os} bytes each, copied in ${ot} us; "
+         "compact_operation ${cs} bytes each, copied in ${ct} us",
+         ("n", count * rounds)
+         ("os", sizeof(operation))("ot", operation_time.count())
+         ("cs", sizeof(compact_operation))("ct", compact_time.count()) );
+#ifdef NDEBUG
+   // The compact form only earns its place if keeping and copying history gets cheaper:
+   BOOST_CHECK_LT( compact_time.count(), operation_time.count() );
+#endif
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/das33_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( das33_benchmarks, database_fixture )
+
+/**
+ * A synthetic das33 launch: many users pledge signed transactions in a burst, more than the phase limit and the per
+ * user cap allow. Accepted and rejected pledges are timed separately; rejected ones should be turned away by the
+ * pledge precheck before their signatures are verified.
+ */
+BOOST_AUTO_TEST_CASE( das33_launch_burst_benchmark )
+{ try {
+#ifdef NDEBUG
+   const uint32_t users = 200;
+#else
+   const uint32_t users = 20;
+#endif
+   const uint32_t pledges_per_user = 20;
+   const uint32_t user_cap_in_pledges = 5;
+
+   ACTOR(owner);
+
+   vector<account_id_type> user_ids;
+   vector<fc::ecc::private_key> user_keys;
+   for( uint32_t i = 0; i < users; ++i )
+   {
+      const auto key = generate_private_key( "launch-user-" + fc::to_string(i) );
+      const auto& user = create_new_account( get_registrar_id(), "launch-user-" + fc::to_string(i), key.get_public_key() );
+      const auto& vault = create_new_vault_account( get_registrar_id(), "launch-vault-" + fc::to_string(i), key.get_public_key() );
+      tether_accounts( user.id, vault.id );
+      issue_dascoin( vault.id, 100 );
+      disable_vault_to_wallet_limit( vault.id );
+      transfer_dascoin_vault_to_wallet( vault.id, user.id, 100 * DASCOIN_DEFAULT_ASSET_PRECISION );
+      user_ids.push_back( user.id );
+      user_keys.push_back( key );
+   }
+
+   asset_id_type token_id = create_new_asset( "LAUNCH", 100000000, 2, price({asset(1),asset(1,asset_id_type(1))}) );
+
+   das33_project_create_operation project_create;
+      project_create.authority       = get_das33_administrator_id();
+      project_create.name            = "launch_project";
+      project_create.owner           = owner_id;
+      project_create.token           = token_id;
+      project_create.discounts       = {{get_dascoin_asset_id(), 100}};
+      project_create.goal_amount_eur = 10000000;
+      project_create.min_pledge      = 0;
+      project_create.max_pledge      = 100000000;
+   do_op( project_create );
+
+   const das33_project_object project = get_das33_projects()[0];
+
+   das33_project_update_operation activate;
+      activate.project_id = project.id;
+      activate.authority  = get_das33_administrator_id();
+      activate.status     = das33_project_status::active;
+   do_op( activate );
+
+   // Size the per user cap and the phase limit from the tokens a single pledge buys:
+   do_op_no_balance_check( das33_pledge_asset_operation( user_ids[0], asset{DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()},
+                                                         optional<license_type_id_type>{}, project.id ) );
+   const share_type tokens_per_pledge = get_das33_pledges().back().base_expected.amount;
+   BOOST_REQUIRE_GT( tokens_per_pledge.value, 0 );
+   const share_type user_cap = tokens_per_pledge.value * (user_cap_in_pledges + 1);
+   const share_type phase_limit = tokens_per_pledge.value * users * user_cap_in_pledges / 2;
+
+   das33_project_update_operation limits;
+      limits.project_id  = project.id;
+      limits.authority   = get_das33_administrator_id();
+      limits.max_pledge  = user_cap;
+      limits.phase_limit = phase_limit;
+   do_op( limits );
+
+   vector<signed_transaction> burst;
+   burst.reserve( users * pledges_per_user );
+   for( uint32_t p = 0; p < pledges_per_user; ++p )
+      for( uint32_t u = 0; u < users; ++u )
+      {
+         signed_transaction tx;
+         tx.operations.emplace_back( das33_pledge_asset_operation( user_ids[u],
+                                                                   asset{DASCOIN_DEFAULT_ASSET_PRECISION + p, get_dascoin_asset_id()},
+                                                                   optional<license_type_id_type>{}, project.id ) );
+         set_expiration( db, tx );
+         sign( tx, user_keys[u] );
+         burst.push_back( std::move(tx) );
+      }
+
+   uint32_t accepted = 0;
+   uint32_t rejected = 0;
+   fc::microseconds accept_time;
+   fc::microseconds reject_time;
+   for( const auto& tx : burst )
+   {
+      const auto start = fc::time_point::now();
+      try
+      {
+         db.push_transaction( tx );
+         accept_time += fc::time_point::now() - start;
+         ++accepted;
+      }
+      catch( const fc::exception& )
+      {
+         reject_time += fc::time_point::now() - start;
+         ++rejected;
+      }
+   }
+
+   BOOST_CHECK_GT( accepted, 0u );
+   BOOST_CHECK_GT( rejected, 0u );
+   BOOST_CHECK_LE( project.id(db).tokens_sold.value, phase_limit.value );
+
+   ilog( "das33 launch burst: ${n} pledges, ${a} accepted at ${ar}/s, ${r} rejected at ${rr}/s",
+         ("n", burst.size())
+         ("a", accepted)("ar", accepted * 1000000ll / std::max<int64_t>( accept_time.count(), 1 ))
+         ("r", rejected)("rr", rejected * 1000000ll / std::max<int64_t>( reject_time.count(), 1 )) );
+#ifdef NDEBUG
+   // The precheck only earns its place if a rejected pledge costs less than an accepted one:
+   BOOST_CHECK_LT( reject_time.count() * int64_t(accepted), accept_time.count() * int64_t(rejected) );
+#endif
+
+   generate_block();
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+#include <algorithm>
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( get_objects_benchmarks, database_fixture )
+
+BOOST_AUTO_TEST_CASE( get_objects_1000_ids_benchmark )
+{ try {
+#ifdef NDEBUG
+   const int iterations = 2000;
+#else
+   const int iterations = 100;
+#endif
+
+   // A request as an explorer sends it: runs of accounts, their statistics and balances, mixed with assets and
+   // global objects, plus a few ids which do not exist.
+   vector<object_id_type> ids;
+   ids.reserve( 1000 );
+   const auto& accounts = db.get_index_type<account_index>().indices();
+   const auto& balances = db.get_index_type<account_balance_index>().indices();
+   while( ids.size() < 1000 )
+   {
+      for( const auto& a : accounts )
+      {
+         ids.push_back( a.id );
+         ids.push_back( a.statistics );
+      }
+      for( const auto& b : balances )
+         ids.push_back( b.id );
+      ids.push_back( asset_id_type() );
+      ids.push_back( global_property_id_type() );
+      ids.push_back( dynamic_global_property_id_type() );
+      ids.push_back( account_id_type( 1000000 ) );
+   }
+   ids.resize( 1000 );
+
+   graphene::app::database_api db_api( db );
+   db_api.set_subscribe_callback( []( const variant& ) {}, false );
+
+   // One lookup per id through find_object:
+   auto start = fc::time_point::now();
+   size_t found_single = 0;
+   for( int i = 0; i < iterations; ++i )
+   {
+      fc::variants result;
+      result.reserve( ids.size() );
+      for( const auto& id : ids )
+      {
+         const object* obj = db.find_object( id );
+         result.push_back( obj ? obj->to_variant() : fc::variant() );
+      }
+      found_single += std::count_if( result.begin(), result.end(), []( const variant& v ) { return !v.is_null(); } );
+   }
+   auto single_elapsed = fc::time_point::now() - start;
+
+   // The batched get_objects:
+   start = fc::time_point::now();
+   size_t found_batched = 0;
+   for( int i = 0; i < iterations; ++i )
+   {
+      const auto result = db_api.get_objects( ids );
+      found_batched += std::count_if( result.begin(), result.end(), []( const variant& v ) { return !v.is_null(); } );
+   }
+   auto batched_elapsed = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( found_single, found_batched );
+
+   ilog( "get_objects: ${n} requests of ${k} ids in ${b} us, ${s} us looking each id up on its own",
+         ("n", iterations)("k", ids.size())("b", batched_elapsed.count())("s", single_elapsed.count()) );
+#ifdef NDEBUG
+   // The batched lookup only earns its place if it is faster:
+   BOOST_CHECK_LT( batched_elapsed.count(), single_elapsed.count() );
+#endif
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/impacted_accounts.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+using namespace graphene::chain;
+
+namespace {
+
+   // A block worth of the operations an account history node sees most, plus a few with many accounts
+   vector<operation> mixed_operations( uint32_t count )
+   {
+      vector<operation> ops;
+      ops.reserve( count );
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         const account_id_type a( 100 + i % 1000 );
+         const account_id_type b( 100 + (i * 7) % 1000 );
+         switch( i % 8 )
+         {
+            case 0:
+            case 1:
+            case 2: {
+               transfer_operation op;
+               op.from = a;
+               op.to = b;
+               ops.emplace_back( op );
+               break;
+            } case 3: {
+               tether_accounts_operation op;
+               op.wallet_account = a;
+               op.vault_account = b;
+               ops.emplace_back( op );
+               break;
+            } case 4: {
+               das33_pledge_asset_operation op;
+               op.account_id = a;
+               ops.emplace_back( op );
+               break;
+            } case 5: {
+               account_update_operation op;
+               op.account = a;
+               op.active = authority( 2, b, 1, account_id_type( b.instance.value + 1 ), 1 );
+               ops.emplace_back( op );
+               break;
+            } case 6: {
+               create_payment_service_provider_operation op;
+               op.authority = a;
+               op.payment_service_provider_account = b;
+               for( uint32_t c = 0; c < 12; ++c )
+                  op.payment_service_provider_clearing_accounts.emplace_back( 2000 + c );
+               ops.emplace_back( op );
+               break;
+            } default: {
+               transfer_operation proposed;
+               proposed.from = b;
+               proposed.to = a;
+               proposal_create_operation op;
+               op.fee_paying_account = a;
+               op.proposed_ops.emplace_back( proposed );
+               ops.emplace_back( op );
+               break;
+            }
+         }
+      }
+      return ops;
+   }
+
+}
+
+BOOST_AUTO_TEST_SUITE( impacted_accounts_benchmarks )
+
+BOOST_AUTO_TEST_CASE( impacted_accounts_benchmark )
+{ try {
+#ifdef NDEBUG
+   const uint32_t rounds = 200;
+#else
+   const uint32_t rounds = 20;
+#endif
+   const auto ops = mixed_operations( 10000 );
+
+   // Both sinks must report the same accounts:
+   for( const auto& op : ops )
+   {
+      flat_set<account_id_type> expected;
+      impacted_accounts_buffer buffer;
+      operation_get_impacted_accounts( op, expected );
+      operation_get_impacted_accounts( op, buffer );
+      BOOST_REQUIRE_EQUAL( expected.size(), buffer.size() );
+      for( const auto& id : buffer )
+         BOOST_REQUIRE( expected.find( id ) != expected.end() );
+   }
+
+   size_t checksum = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto& op : ops )
+      {
+         flat_set<account_id_type> impacted;
+         operation_get_impacted_accounts( op, impacted );
+         checksum += impacted.size();
+      }
+   const auto flat_set_time = fc::time_point::now() - start;
+
+   size_t buffer_checksum = 0;
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto& op : ops )
+      {
+         impacted_accounts_buffer impacted;
+         operation_get_impacted_accounts( op, impacted );
+         buffer_checksum += impacted.size();
+      }
+   const auto buffer_time = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( checksum, buffer_checksum );
+   ilog( "impacted accounts of ${n} operations: flat_set ${f} us, fixed buffer ${b} us",
+         ("n", ops.size() * rounds)("f", flat_set_time.count())("b", buffer_time.count()) );
+#ifdef NDEBUG
+   // The fixed buffer only earns its place if it is faster:
+   BOOST_CHECK_LT( buffer_time.count(), flat_set_time.count() );
+#endif
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
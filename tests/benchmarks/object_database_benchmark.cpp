@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( object_database_benchmarks, database_fixture )
+
+BOOST_AUTO_TEST_CASE( adjust_balance_benchmark )
+{ try {
+#ifdef NDEBUG
+   const int iterations = 5000000;
+#else
+   const int iterations = 200000;
+#endif
+
+   ACTOR(alice)
+   db.adjust_balance(alice_id, asset(1, asset_id_type()));
+   const auto& balance = db.get_balance_object(alice_id, asset_id_type());
+
+   // adjust_balance() modifies through the statically typed primary index:
+   auto start = fc::time_point::now();
+   for( int i = 0; i < iterations; ++i )
+      db.adjust_balance(alice_id, asset(1, asset_id_type()));
+   auto typed_elapsed = fc::time_point::now() - start;
+
+   // The same modification through the type erased index interface:
+   start = fc::time_point::now();
+   for( int i = 0; i < iterations; ++i )
+      db.modify(static_cast<const object&>(balance), [](object& o) {
+         static_cast<account_balance_object&>(o).balance += 1;
+      });
+   auto virtual_elapsed = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( balance.balance.value, 2 * iterations + 1 );
+
+   ilog("adjust_balance: ${n} typed modifications in ${t} us, ${v} us through the virtual index interface",
+        ("n", iterations)("t", typed_elapsed.count())("v", virtual_elapsed.count()));
+#ifdef NDEBUG
+   // The typed path only earns its place if it is faster:
+   BOOST_CHECK_LT( typed_elapsed.count(), virtual_elapsed.count() );
+#endif
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -59,6 +59,53 @@ namespace graphene { namespace chain {
 using std::cout;
 using std::cerr;
 
+namespace {
+
+/**
+ * Object databases produced by init_genesis, built once per process and keyed by the digest of the genesis state
+ * they were built from. Fixtures copy a snapshot into their own data directory and load it instead of running
+ * init_genesis again.
+ */
+struct genesis_snapshot_cache
+{
+   fc::temp_directory root{ graphene::utilities::temp_directory_path() };
+   std::map<fc::sha256, fc::path> snapshots;
+};
+
+void copy_snapshot( const boost::filesystem::path& from, const boost::filesystem::path& to )
+{
+   boost::filesystem::create_directories( to );
+   for( boost::filesystem::directory_iterator it( from ), end; it != end; ++it )
+   {
+      const auto target = to / it->path().filename();
+      if( boost::filesystem::is_directory( it->status() ) )
+         copy_snapshot( it->path(), target );
+      else
+         boost::filesystem::copy_file( it->path(), target );
+   }
+}
+
+const fc::path& genesis_snapshot( const genesis_state_type& genesis )
+{
+   static genesis_snapshot_cache cache;
+
+   const auto key = fc::digest( genesis );
+   auto itr = cache.snapshots.find( key );
+   if( itr == cache.snapshots.end() )
+   {
+      const fc::path dir = cache.root.path() / key.str();
+      {
+         database genesis_db;
+         genesis_db.open( dir, [&genesis]{ return genesis; }, "test" );
+         genesis_db.close( false );
+      }
+      itr = cache.snapshots.emplace( key, dir ).first;
+   }
+   return itr->second;
+}
+
+} // anonymous namespace
+
 void database_fixture::init_genesis_state()
 {
    genesis_state.initial_timestamp = time_point_sec( GRAPHENE_TESTING_GENESIS_TIMESTAMP );
@@ -123,6 +170,11 @@ void database_fixture::init_genesis_state()
 }
 
 database_fixture::database_fixture()
+   : database_fixture( boost::program_options::variables_map() )
+{
+}
+
+database_fixture::database_fixture( const boost::program_options::variables_map& account_history_options )
    : app(), db( *app.chain_database() ), _dal(db)
 {
    try {
@@ -133,6 +185,8 @@ database_fixture::database_fixture()
       const std::string arg = argv[i];
       if( arg == "--record-assert-trip" )
          fc::enable_record_assert_trip = true;
+      if( arg == "--no-genesis-snapshot" )
+         use_genesis_snapshot = false;
       if( arg == "--show-test-names" )
          std::cout << "running test " << boost::unit_test::framework::current_test_case().p_name << std::endl;
    }
@@ -162,7 +216,7 @@ database_fixture::database_fixture()
 
    // app.initialize();
    ahplugin->plugin_set_app(&app);
-   ahplugin->plugin_initialize(options);
+   ahplugin->plugin_initialize(account_history_options);
    mhplugin->plugin_set_app(&app);
    mhplugin->plugin_initialize(options);
 
@@ -366,6 +420,8 @@ void database_fixture::open_database()
 {
    if( !data_dir ) {
       data_dir = fc::temp_directory( graphene::utilities::temp_directory_path() );
+      if( use_genesis_snapshot )
+         copy_snapshot( genesis_snapshot( genesis_state ), data_dir->path() );
       db.open(data_dir->path(), [this]{return genesis_state;}, "test");
    }
 }
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <graphene/app/application.hpp>
+#include <boost/program_options/variables_map.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/access_layer.hpp>
 #include <fc/io/json.hpp>
@@ -177,11 +178,15 @@ struct database_fixture {
 
    optional<fc::temp_directory> data_dir;
    bool skip_key_index_test = false;
+   // Load the process wide genesis snapshot instead of running init_genesis for every test case
+   bool use_genesis_snapshot = true;
    uint32_t anon_acct_count;
 
    static constexpr uint32_t apply_bonus(uint32_t value, uint32_t bonus);
 
    database_fixture();
+   /** Starts the account_history plugin with these options instead of the defaults */
+   explicit database_fixture( const boost::program_options::variables_map& account_history_options );
    ~database_fixture();
 
    void init_genesis_state();
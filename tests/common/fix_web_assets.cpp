@@ -247,9 +247,7 @@ void database_fixture::set_external_btc_price(price eur_amount_per_btc)
 void database_fixture::set_last_dascoin_price(price val)
 { try {
 
-  db.modify(get_dynamic_global_properties(), [val](dynamic_global_property_object& dgpo){
-    dgpo.last_dascoin_price = val;
-  });
+  db.set_last_price(market_key{get_dascoin_asset_id(), get_web_asset_id()}, val);
 
 } FC_LOG_AND_RETHROW() }
 
@@ -0,0 +1,277 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/account_history/account_history_plugin.hpp>
+#include <graphene/app/api.hpp>
+#include <graphene/chain/impacted_accounts.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using namespace graphene::account_history;
+
+namespace {
+  optional<operation_history_object> make_transfer( uint32_t block_num, account_id_type from, account_id_type to )
+  {
+    transfer_operation op;
+    op.from = from;
+    op.to = to;
+    operation_history_object oho( op );
+    oho.block_num = block_num;
+    return oho;
+  }
+
+  history_batch make_batch( uint32_t block_num, const vector<optional<operation_history_object>>& operations )
+  {
+    history_batch batch;
+    batch.block_num = block_num;
+    batch.operations = operations;
+    return batch;
+  }
+
+  void apply( sharded_history_store& store, history_batch&& batch )
+  {
+    store.apply( std::move(batch),
+                 []( const operation_history_object& op, impacted_accounts_buffer& accounts ) {
+                   operation_get_history_accounts( op.op.to_operation(), op.result, accounts );
+                 },
+                 []( account_id_type ) { return true; } );
+  }
+
+  vector<uint64_t> history_ids( const sharded_history_store& store, account_id_type account )
+  {
+    vector<uint64_t> ids;
+    for( const auto& op : store.get_account_history( account, operation_history_id_type(), 100, operation_history_id_type(),
+                                                     []( const operation_history_object& ) { return true; } ) )
+      ids.push_back( op.id.instance() );
+    return ids;
+  }
+
+  vector<uint64_t> history_ids( const vector<operation_history_object>& ops )
+  {
+    vector<uint64_t> ids;
+    for( const auto& op : ops )
+      ids.push_back( op.id.instance() );
+    return ids;
+  }
+
+  const account_id_type alice( 100 ), bob( 101 ), carol( 102 );
+
+  /** Three blocks numbered from 10 on; the second operation of block 1 failed */
+  void fill( sharded_history_store& store )
+  {
+    store.start_numbering_at( 10 );
+    apply( store, make_batch( 1, { make_transfer( 1, alice, bob ), optional<operation_history_object>() } ) );
+    apply( store, make_batch( 2, { make_transfer( 2, alice, carol ) } ) );
+    apply( store, make_batch( 3, { make_transfer( 3, bob, carol ) } ) );
+  }
+
+  /** Indexes account history asynchronously; the options are the ones a node would get on its command line */
+  boost::program_options::variables_map async_history_options()
+  {
+    boost::program_options::variables_map options;
+    options.emplace( "history-async-shards", boost::program_options::variable_value( uint32_t(4), false ) );
+    options.emplace( "history-max-lag", boost::program_options::variable_value( uint32_t(2), false ) );
+    return options;
+  }
+
+  struct async_history_fixture : database_fixture
+  {
+    async_history_fixture() : database_fixture( async_history_options() ) {}
+
+    std::shared_ptr<account_history_plugin> plugin()
+    {
+      return app.get_plugin<account_history_plugin>( "account_history" );
+    }
+  };
+
+  void create_accounts( database_fixture& f, const string& prefix, int count )
+  {
+    for( int i = 0; i < count; ++i )
+    {
+      f.create_new_account( f.get_registrar_id(), prefix + std::to_string( i ) );
+      f.generate_block();
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( dascoin_tests )
+BOOST_AUTO_TEST_SUITE( account_history_tests )
+
+BOOST_AUTO_TEST_CASE( impacted_accounts_order_test )
+{ try {
+  // The buffer iterates in ascending order without duplicates, inline and once spilled, like flat_set:
+  impacted_accounts_buffer buffer;
+  flat_set<account_id_type> expected;
+  for( uint64_t i : { 9, 3, 7, 3, 12, 1, 9, 5, 8, 2 } )
+  {
+    buffer.insert( account_id_type( i ) );
+    expected.insert( account_id_type( i ) );
+    BOOST_REQUIRE( vector<account_id_type>( buffer.begin(), buffer.end() )
+                   == vector<account_id_type>( expected.begin(), expected.end() ) );
+  }
+  BOOST_CHECK( buffer.spilled() );
+
+  // The account history plugin creates its per account entries in this order, so it must not depend on which
+  // account was collected first; here the sender is collected before the lower numbered receiver:
+  const auto oho = make_transfer( 1, account_id_type( 20 ), account_id_type( 10 ) );
+  impacted_accounts_buffer history_accounts;
+  operation_get_history_accounts( oho->op.to_operation(), oho->result, history_accounts );
+  BOOST_CHECK( (vector<account_id_type>( history_accounts.begin(), history_accounts.end() )
+                == vector<account_id_type>{ account_id_type( 10 ), account_id_type( 20 ) }) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( history_store_numbering_test )
+{ try {
+  sharded_history_store store( 4 );
+  fill( store );
+
+  // The failed operation uses up number 11 like it does in the database:
+  BOOST_CHECK( history_ids( store, alice ) == vector<uint64_t>({ 12, 10 }) );
+  BOOST_CHECK( history_ids( store, bob ) == vector<uint64_t>({ 13, 10 }) );
+  BOOST_CHECK( history_ids( store, carol ) == vector<uint64_t>({ 13, 12 }) );
+  BOOST_CHECK_EQUAL( store.indexed_block_num(), 3 );
+
+  // Paging: ids in (stop, start]
+  const auto page = store.get_account_history( carol, operation_history_id_type(12), 100, operation_history_id_type(13),
+                                               []( const operation_history_object& ) { return true; } );
+  BOOST_CHECK( history_ids( page ) == vector<uint64_t>({ 13 }) );
+
+  GRAPHENE_REQUIRE_THROW( store.start_numbering_at( 0 ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( history_store_fork_test )
+{ try {
+  sharded_history_store store( 4 );
+  fill( store );
+
+  // A new block 2 drops blocks 2 and 3 and numbers its operations where the old block 2 started:
+  apply( store, make_batch( 2, { make_transfer( 2, carol, bob ) } ) );
+  BOOST_CHECK_EQUAL( store.indexed_block_num(), 2 );
+  BOOST_CHECK( history_ids( store, alice ) == vector<uint64_t>({ 10 }) );
+  BOOST_CHECK( history_ids( store, bob ) == vector<uint64_t>({ 12, 10 }) );
+  BOOST_CHECK( history_ids( store, carol ) == vector<uint64_t>({ 12 }) );
+
+  const auto latest = store.get_account_history( bob, operation_history_id_type(), 1, operation_history_id_type(),
+                                                 []( const operation_history_object& ) { return true; } );
+  BOOST_REQUIRE_EQUAL( latest.size(), 1 );
+  BOOST_CHECK( latest[0].op.get<transfer_operation>().from == carol );
+
+  // A fork whose blocks number nothing continues from the kept ones:
+  apply( store, make_batch( 2, {} ) );
+  apply( store, make_batch( 3, { make_transfer( 3, alice, bob ) } ) );
+  BOOST_CHECK( history_ids( store, alice ) == vector<uint64_t>({ 12, 10 }) );
+  BOOST_CHECK( history_ids( store, carol ).empty() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( history_store_save_load_test )
+{ try {
+  fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+  const fc::path file = dir.path() / "account_history_store";
+  {
+    sharded_history_store store( 4 );
+    fill( store );
+    store.save( file );
+  }
+
+  // Loaded with a different shard count at the block it was saved at:
+  sharded_history_store same( 3 );
+  BOOST_CHECK( same.load( file, 3 ) );
+  BOOST_CHECK_EQUAL( same.indexed_block_num(), 3 );
+  BOOST_CHECK( history_ids( same, alice ) == vector<uint64_t>({ 12, 10 }) );
+  BOOST_CHECK( history_ids( same, carol ) == vector<uint64_t>({ 13, 12 }) );
+
+  // The database was saved before the last block, which is applied again after the restart:
+  sharded_history_store behind( 4 );
+  BOOST_CHECK( behind.load( file, 2 ) );
+  BOOST_CHECK_EQUAL( behind.indexed_block_num(), 2 );
+  BOOST_CHECK( history_ids( behind, carol ) == vector<uint64_t>({ 12 }) );
+  apply( behind, make_batch( 3, { make_transfer( 3, bob, carol ) } ) );
+  BOOST_CHECK( history_ids( behind, carol ) == vector<uint64_t>({ 13, 12 }) );
+
+  // Blocks missing from the file can not be recovered:
+  sharded_history_store ahead( 4 );
+  BOOST_CHECK( !ahead.load( file, 4 ) );
+  BOOST_CHECK_EQUAL( ahead.indexed_block_num(), 0 );
+  BOOST_CHECK( !ahead.load( dir.path() / "missing", 0 ) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( async_history_api_test )
+{ try {
+  database_fixture sync_node;
+  async_history_fixture async_node;
+  create_accounts( sync_node, "history", 5 );
+  create_accounts( async_node, "history", 5 );
+  async_node.plugin()->wait_for_async_history();
+
+  graphene::app::history_api sync_api( sync_node.app );
+  graphene::app::history_api async_api( async_node.app );
+  const account_id_type registrar = sync_node.get_registrar_id();
+  BOOST_REQUIRE( async_node.plugin()->async_history() != nullptr );
+  BOOST_CHECK_EQUAL( async_api.get_account_history_block_num(), async_node.db.head_block_num() );
+
+  // Both modes number operations alike, so ids from either page through the other:
+  const auto all = sync_api.get_account_history( registrar, operation_history_id_type(), 100, operation_history_id_type() );
+  BOOST_REQUIRE_GE( all.size(), 5u );
+  BOOST_CHECK( history_ids( async_api.get_account_history( registrar, operation_history_id_type(), 100,
+                                                           operation_history_id_type() ) ) == history_ids( all ) );
+
+  const operation_history_id_type start = all[1].id;
+  const operation_history_id_type stop = all[4].id;
+  BOOST_CHECK( history_ids( async_api.get_account_history( registrar, stop, 2, start ) )
+               == history_ids( sync_api.get_account_history( registrar, stop, 2, start ) ) );
+  BOOST_CHECK( history_ids( async_api.get_relative_account_history( registrar, 0, 3, 0 ) )
+               == history_ids( sync_api.get_relative_account_history( registrar, 0, 3, 0 ) ) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( async_history_back_pressure_test, async_history_fixture )
+{ try {
+  const sharded_history_store* store = plugin()->async_history();
+  BOOST_REQUIRE( store != nullptr );
+
+  // With --history-max-lag 2 block application waits whenever indexing falls further behind:
+  for( int i = 0; i < 10; ++i )
+  {
+    create_new_account( get_registrar_id(), "lagging" + std::to_string( i ) );
+    generate_block();
+    BOOST_CHECK_GE( store->indexed_block_num() + 2, db.head_block_num() );
+  }
+
+  plugin()->wait_for_async_history();
+  BOOST_CHECK_EQUAL( store->indexed_block_num(), db.head_block_num() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::account_history_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -261,5 +261,75 @@ BOOST_AUTO_TEST_CASE(update_global_parameters_test)
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( account_member_index_field_filter_test )
+{ try {
+  ACTOR(wallet)
+  const auto& members = db.get_index_type<account_index>().get_secondary_index<account_member_index>();
+  const auto new_key = generate_private_key("new_key").get_public_key();
+
+  // Modifying a field the index does not watch leaves the memberships alone:
+  db.modify(wallet, [](account_object& a) { a.pi_level = 3; });
+  BOOST_CHECK( members.account_to_key_memberships.at(wallet_public_key).count(wallet_id) );
+  BOOST_CHECK( members.account_to_key_memberships.find(new_key) == members.account_to_key_memberships.end() );
+
+  // Replacing the active key moves the membership:
+  db.modify(wallet, [&](account_object& a) {
+    a.active = authority(1, public_key_type(new_key), 1);
+    a.owner = a.active;
+    a.options.memo_key = new_key;
+  });
+  BOOST_CHECK( members.account_to_key_memberships.at(new_key).count(wallet_id) );
+  BOOST_CHECK( !members.account_to_key_memberships.at(wallet_public_key).count(wallet_id) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( account_name_search_index_test )
+{ try {
+  BOOST_CHECK( db.get_account_name_search() == nullptr );
+  // Accounts created at genesis are indexed when the search is enabled:
+  db.enable_account_name_search();
+  const auto& search = *db.get_account_name_search();
+  BOOST_CHECK( search.search( "null-acc", account_id_type(), 10 ) == vector<account_id_type>{ GRAPHENE_NULL_ACCOUNT } );
+
+  ACTORS((alicewallet)(bobwallet));
+  VAULT_ACTOR(alicevault);
+
+  BOOST_CHECK( (search.search( "alice", account_id_type(), 10 ) == vector<account_id_type>{ alicewallet_id, alicevault_id }) );
+  BOOST_CHECK( (search.search( "wallet", account_id_type(), 10 ) == vector<account_id_type>{ alicewallet_id, bobwallet_id }) );
+  BOOST_CHECK( search.search( "bobvault", account_id_type(), 10 ).empty() );
+
+  // Paging continues after the last account returned:
+  BOOST_CHECK( search.search( "wallet", account_id_type(), 1 ) == vector<account_id_type>{ alicewallet_id } );
+  BOOST_CHECK( search.search( "wallet", alicewallet_id + 1, 1 ) == vector<account_id_type>{ bobwallet_id } );
+
+  // Queries shorter than a trigram would scan every name, so they find nothing:
+  BOOST_CHECK( search.search( "ce", account_id_type(), 10 ).empty() );
+  BOOST_CHECK( (search.search( "ice", alicewallet_id, 10 ) == vector<account_id_type>{ alicewallet_id, alicevault_id }) );
+
+  // Renaming moves the account in the index:
+  db.modify( bobwallet, []( account_object& a ) { a.name = "bobvault"; } );
+  BOOST_CHECK( search.search( "bobvault", account_id_type(), 10 ) == vector<account_id_type>{ bobwallet_id } );
+  BOOST_CHECK( search.search( "wallet", account_id_type(), 10 ) == vector<account_id_type>{ alicewallet_id } );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( nested_modify_watched_fields_test )
+{ try {
+  db.enable_account_name_search();
+  const auto& search = *db.get_account_name_search();
+  ACTORS((alicewallet)(bobwallet));
+
+  // A modification made from within another one on the same index must not clobber the outer one's saved fields:
+  db.modify( bobwallet, [&]( account_object& a ) {
+    db.modify( alicewallet, []( account_object& inner ) { inner.name = "alicevault"; } );
+    a.name = "bobvault";
+  });
+
+  BOOST_CHECK( search.search( "wallet", account_id_type(), 10 ).empty() );
+  BOOST_CHECK( search.search( "alicevault", account_id_type(), 10 ) == vector<account_id_type>{ alicewallet_id } );
+  BOOST_CHECK( search.search( "bobvault", account_id_type(), 10 ) == vector<account_id_type>{ bobwallet_id } );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()  // account_unit_tests
 BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
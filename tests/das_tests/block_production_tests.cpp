@@ -0,0 +1,135 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/app/database_api.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/database.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( block_production_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( block_production_time_budget_test )
+{ try {
+  graphene::app::database_api db_api(db);
+  const auto before = db_api.get_block_production_stats();
+
+  // Any transaction after the first one overruns a budget of a microsecond:
+  db.node_properties().block_production_time_budget = fc::microseconds(1);
+  set_expiration( db, trx );
+  create_account(get_registrar_id(), "alice");
+  create_account(get_registrar_id(), "bob");
+  create_account(get_registrar_id(), "carol");
+
+  // Generating with a check the pending transactions skipped rules out the block template, so they are applied again:
+  const auto block = generate_block(~database::skip_merkle_check);
+  BOOST_CHECK_EQUAL( block.transactions.size(), 1u );
+
+  const auto stats = db_api.get_block_production_stats();
+  BOOST_CHECK_EQUAL( stats.blocks_generated, before.blocks_generated + 1 );
+  BOOST_CHECK_EQUAL( stats.blocks_over_budget, before.blocks_over_budget + 1 );
+  BOOST_CHECK_EQUAL( stats.transactions_deferred, before.transactions_deferred + 2 );
+  BOOST_CHECK( stats.last_generation_time.count() > 0 );
+  BOOST_CHECK( stats.max_generation_time >= stats.last_generation_time );
+
+  // Without a budget nothing is deferred:
+  db.node_properties().block_production_time_budget = fc::microseconds();
+  create_account(get_registrar_id(), "dave");
+  create_account(get_registrar_id(), "eve");
+  BOOST_CHECK_EQUAL( generate_block(~database::skip_merkle_check).transactions.size(), 2u );
+  BOOST_CHECK_EQUAL( db_api.get_block_production_stats().blocks_over_budget, stats.blocks_over_budget );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( block_template_reuse_test )
+{ try {
+  graphene::app::database_api db_api(db);
+  const auto before = db_api.get_block_production_stats();
+
+  // The template is taken as it is, so the pending transactions are not applied again and none is deferred:
+  db.node_properties().block_production_time_budget = fc::microseconds(1);
+  set_expiration( db, trx );
+  create_account(get_registrar_id(), "alice");
+  create_account(get_registrar_id(), "bob");
+  create_account(get_registrar_id(), "carol");
+
+  const auto block = generate_block();
+  BOOST_CHECK_EQUAL( block.transactions.size(), 3u );
+  BOOST_CHECK( block.transaction_merkle_root == block.calculate_merkle_root() );
+  BOOST_CHECK( db.fetch_block_by_number(block.block_num())->id() == block.id() );
+
+  const auto stats = db_api.get_block_production_stats();
+  BOOST_CHECK_EQUAL( stats.blocks_generated, before.blocks_generated + 1 );
+  BOOST_CHECK_EQUAL( stats.blocks_over_budget, before.blocks_over_budget );
+
+  // The next block starts a new template:
+  create_account(get_registrar_id(), "dave");
+  BOOST_CHECK_EQUAL( generate_block().transactions.size(), 1u );
+  BOOST_CHECK( db.get_index_type<account_index>().indices().get<by_name>().count("dave") );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( block_template_invalidation_test )
+{ try {
+  graphene::app::database_api db_api(db);
+  set_expiration( db, trx );
+  create_account(get_registrar_id(), "alice");
+  generate_block();
+
+  // Popping the head block drops the pending state the template was built on:
+  create_account(get_registrar_id(), "bob");
+  create_account(get_registrar_id(), "carol");
+  db.pop_block();
+
+  // so the pending transactions are applied again, which the budget only lets the first one of do:
+  const auto before = db_api.get_block_production_stats();
+  db.node_properties().block_production_time_budget = fc::microseconds(1);
+  const auto block = generate_block();
+  BOOST_CHECK_EQUAL( block.transactions.size(), 1u );
+  BOOST_CHECK( block.transaction_merkle_root == block.calculate_merkle_root() );
+  BOOST_CHECK_EQUAL( db_api.get_block_production_stats().transactions_deferred, before.transactions_deferred + 1 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( block_broadcast_latency_stats_test )
+{ try {
+  graphene::app::database_api db_api(db);
+
+  // The witness plugin records the latency of every block it broadcasts:
+  db.record_block_broadcast_latency( fc::milliseconds(120) );
+  db.record_block_broadcast_latency( fc::milliseconds(-5) );
+  const auto stats = db_api.get_block_production_stats();
+  BOOST_CHECK( stats.last_broadcast_latency == fc::milliseconds(-5) );
+  BOOST_CHECK( stats.max_broadcast_latency == fc::milliseconds(120) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // block_production_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
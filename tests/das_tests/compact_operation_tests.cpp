@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+#include <graphene/chain/protocol/compact_operation.hpp>
+
+#include <fc/io/json.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( compact_operation_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( compact_operation_test )
+{ try {
+  transfer_operation transfer;
+  transfer.from = account_id_type(5);
+  transfer.to = account_id_type(6);
+  transfer.amount = asset(100, get_dascoin_asset_id());
+  asset_create_operation create;
+  create.symbol = "FOO";
+  create.precision = 4;
+
+  for( const operation& op : { operation(transfer), operation(create) } )
+  {
+    const compact_operation compact( op );
+    BOOST_CHECK_EQUAL( compact.which(), op.which() );
+    BOOST_CHECK( fc::raw::pack(compact) == fc::raw::pack(op) );
+    BOOST_CHECK_EQUAL( fc::json::to_string(compact), fc::json::to_string(op) );
+
+    compact_operation unpacked;
+    fc::raw::unpack( fc::raw::pack(op), unpacked );
+    BOOST_CHECK( fc::raw::pack(unpacked.to_operation()) == fc::raw::pack(op) );
+  }
+
+  // The common operations are kept in place, the rare ones are shared out of line:
+  const compact_operation compact_transfer( transfer );
+  BOOST_CHECK( compact_transfer.is_inline_stored() );
+  BOOST_CHECK( compact_transfer.get<transfer_operation>().to == transfer.to );
+  const compact_operation compact_create( create );
+  BOOST_CHECK( !compact_create.is_inline_stored() );
+  BOOST_CHECK_EQUAL( compact_create.get<asset_create_operation>().symbol, "FOO" );
+
+  // Operation history keeps its operations compact and serializes them unchanged:
+  const operation_history_object history( create );
+  BOOST_CHECK( !history.op.is_inline_stored() );
+  operation_history_object unpacked_history;
+  fc::raw::unpack( fc::raw::pack(history), unpacked_history );
+  BOOST_CHECK_EQUAL( unpacked_history.op.get<asset_create_operation>().symbol, "FOO" );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // compact_operation_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/confidential_proof_verifier.hpp>
+#include <graphene/chain/database.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( confidential_proof_verifier_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( confidential_proof_verifier_test )
+{ try {
+  signed_transaction plain;
+  plain.operations.push_back( transfer_operation() );
+  BOOST_CHECK( !confidential_proof_verifier::has_proofs( plain ) );
+
+  // Sorted, but the commitments do not add up:
+  blind_transfer_operation bto;
+  bto.inputs.resize( 1 );
+  bto.outputs.resize( 1 );
+  bto.inputs[0].commitment.data[0] = 1;
+  bto.outputs[0].commitment.data[0] = 2;
+  bto.outputs[0].owner = authority( 1, account_id_type(5), 1 );
+  signed_transaction blind;
+  blind.operations.push_back( bto );
+  BOOST_CHECK( confidential_proof_verifier::has_proofs( blind ) );
+  confidential_proof_verifier::validate_without_proofs( blind );
+  GRAPHENE_REQUIRE_THROW( blind.validate(), fc::exception );
+
+  // The failure is remembered, whether it was found on a worker thread or on the calling one:
+  confidential_proof_verifier verifier;
+  GRAPHENE_REQUIRE_THROW( verifier.verify( blind ), fc::exception );
+  GRAPHENE_REQUIRE_THROW( verifier.verify( blind ), fc::exception );
+
+  signed_block block;
+  block.transactions.emplace_back( blind );
+  block.transactions.back().expiration = fc::time_point_sec( 1 );
+  confidential_proof_verifier precomputed;
+  precomputed.precompute( block );
+  GRAPHENE_REQUIRE_THROW( precomputed.verify( block.transactions.back() ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // confidential_proof_verifier_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
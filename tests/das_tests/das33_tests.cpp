@@ -23,6 +23,7 @@
  */
 
 #include <boost/test/unit_test.hpp>
+#include <graphene/app/database_api.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/access_layer.hpp>
 #include <graphene/chain/exceptions.hpp>
@@ -315,7 +316,7 @@ BOOST_AUTO_TEST_CASE( das33_pledge_test_phase_limit )
     // Set last dascoin price
     set_last_dascoin_price(asset(2 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()) / asset(1 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id()));
 
-    price last_dsc_price = get_dynamic_global_properties().last_dascoin_price;
+    price last_dsc_price = db.get_last_dascoin_price();
     BOOST_CHECK_EQUAL( last_dsc_price.to_real(), 2000);
 
     // Create project
@@ -425,6 +426,123 @@ BOOST_AUTO_TEST_CASE( das33_pledge_test_overflow )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( das33_pledge_precheck_test )
+{ try {
+
+    ACTORS((user)(user2)(user3)(owner));
+    VAULT_ACTORS((vault)(vault2)(vault3));
+
+    const auto fund = [&](account_id_type wallet, account_id_type vault, share_type dsc) {
+      tether_accounts(wallet, vault);
+      issue_dascoin(vault, dsc);
+      disable_vault_to_wallet_limit(vault);
+      transfer_dascoin_vault_to_wallet(vault, wallet, dsc * DASCOIN_DEFAULT_ASSET_PRECISION);
+    };
+    fund(user_id, vault_id, 100);
+    fund(user2_id, vault2_id, 100);
+    fund(user3_id, vault3_id, 2000);
+
+    asset_id_type test_asset_id = create_new_asset("TEST", 100000, 2, price({asset(1),asset(1,asset_id_type(1))}));
+    set_last_dascoin_price(asset(1 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()) / asset(1 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id()));
+
+    das33_project_create_operation project_create;
+        project_create.authority       = get_das33_administrator_id();
+        project_create.name            = "test_project0";
+        project_create.owner           = owner_id;
+        project_create.token           = test_asset_id;
+        project_create.discounts       = {{get_dascoin_asset_id(), 100}};
+        project_create.goal_amount_eur = 100000;
+        project_create.min_pledge      = 0;
+        project_create.max_pledge      = 100000;
+    do_op(project_create);
+
+    const das33_project_id_type project_id = get_das33_projects()[0].id;
+    const auto project = [&]() -> const das33_project_object& { return project_id(db); };
+
+    das33_project_update_operation project_update;
+        project_update.project_id = project_id;
+        project_update.authority  = get_das33_administrator_id();
+        project_update.status     = das33_project_status::active;
+    do_op(project_update);
+
+    const auto pledge = [&](account_id_type account, share_type dsc) -> operation {
+      return das33_pledge_asset_operation(account, asset{dsc * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()},
+                                          optional<license_type_id_type>{}, project_id);
+    };
+
+    // Unsigned transactions either get turned away by the precheck or go on to fail on their missing signatures:
+    const auto push_unsigned = [&](const vector<operation>& ops) -> string {
+      signed_transaction tx;
+      tx.operations = ops;
+      set_expiration(db, tx);
+      try {
+        db.push_transaction(tx, database::skip_tapos_check);
+      } catch( const fc::exception& e ) {
+        return e.to_detail_string();
+      }
+      BOOST_FAIL( "an unsigned transaction was accepted" );
+      return string();
+    };
+    const auto rejected_by_precheck = [&](const vector<operation>& ops, const string& reason) {
+      return push_unsigned(ops).find(reason) != string::npos;
+    };
+    const auto passes_precheck = [&](const vector<operation>& ops) {
+      return push_unsigned(ops).find("Missing Active Authority") != string::npos;
+    };
+    const auto push_signed = [&](const vector<operation>& ops) {
+      signed_transaction tx;
+      tx.operations = ops;
+      set_expiration(db, tx);
+      db.push_transaction(tx, ~0);
+    };
+
+    // Size the limits from the tokens a single DSC buys:
+    do_op_no_balance_check(pledge(user_id, 1));
+    const share_type tokens_per_dsc = project().tokens_sold;
+    BOOST_REQUIRE_GT( tokens_per_dsc.value, 0 );
+    BOOST_REQUIRE_LE( tokens_per_dsc.value * 4, 100000 );
+    BOOST_REQUIRE_GE( tokens_per_dsc.value * 2000, 100000 );
+
+    das33_project_update_operation limits;
+        limits.project_id  = project_id;
+        limits.authority   = get_das33_administrator_id();
+        limits.min_pledge  = tokens_per_dsc;
+        limits.max_pledge  = tokens_per_dsc * 3;
+        limits.phase_limit = tokens_per_dsc * 4;
+    do_op(limits);
+
+    // Per user cap: a pledge which brings the user exactly to the cap is let through, the next one is not
+    BOOST_CHECK( passes_precheck({ pledge(user_id, 2) }) );
+    do_op_no_balance_check(pledge(user_id, 2));
+    BOOST_CHECK( rejected_by_precheck({ pledge(user_id, 1) }, "Can not buy more then") );
+
+    // Pledges are each checked against the state before the transaction, so several pledges which together
+    // cross a limit pass the precheck and are left to the evaluator, which still rejects the whole transaction:
+    BOOST_CHECK( passes_precheck({ pledge(user2_id, 1), pledge(user2_id, 1) }) );
+    GRAPHENE_REQUIRE_THROW( push_signed({ pledge(user2_id, 1), pledge(user2_id, 1) }), fc::exception );
+    BOOST_CHECK_EQUAL( project().tokens_sold.value, tokens_per_dsc.value * 3 );
+
+    // Phase limit: a pledge which sells the last tokens of the phase is let through, the next one is not
+    BOOST_CHECK( passes_precheck({ pledge(user2_id, 1) }) );
+    do_op_no_balance_check(pledge(user2_id, 1));
+    BOOST_CHECK_EQUAL( project().tokens_sold.value, project().phase_limit.value );
+    BOOST_CHECK( rejected_by_precheck({ pledge(user3_id, 1) }, "All tokens in this phase are sold") );
+
+    // Max supply: lift the phase limit and the cap, and let user3 pledge the whole balance, which is trimmed to what is left
+    das33_project_update_operation open_phase;
+        open_phase.project_id  = project_id;
+        open_phase.authority   = get_das33_administrator_id();
+        open_phase.max_pledge  = tokens_per_dsc * 2000;
+        open_phase.phase_limit = share_type(100000);
+    do_op(open_phase);
+    BOOST_CHECK( passes_precheck({ pledge(user3_id, 2000) }) );
+    BOOST_CHECK( rejected_by_precheck({ pledge(user3_id, 2001) }, "Not enough balance") );
+    do_op_no_balance_check(pledge(user3_id, 2000));
+    BOOST_CHECK_EQUAL( project().tokens_sold.value, 100000 );
+    BOOST_CHECK( rejected_by_precheck({ pledge(user2_id, 1) }, "All tokens for project are sold") );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( das33_pledge_test_bitcoin )
 { try {
 
@@ -696,6 +814,140 @@ BOOST_AUTO_TEST_CASE( das33_reject_project_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( das33_pledge_totals_test )
+{ try {
+
+    ACTOR(user);
+    ACTOR(owner);
+    VAULT_ACTOR(vault);
+
+    tether_accounts(user_id, vault_id);
+
+    issue_dascoin(vault_id, 100);
+    disable_vault_to_wallet_limit(vault_id);
+    transfer_dascoin_vault_to_wallet(vault_id, user_id, 100 * DASCOIN_DEFAULT_ASSET_PRECISION);
+
+    asset_id_type test_asset_id = create_new_asset("TOTALS", 100000000, 2, price({asset(1),asset(1,asset_id_type(1))}));
+
+    das33_project_create_operation project_create;
+        project_create.authority       = get_das33_administrator_id();
+        project_create.name            = "totals_project";
+        project_create.owner           = owner_id;
+        project_create.token           = test_asset_id;
+        project_create.discounts       = {{get_dascoin_asset_id(), 50}};
+        project_create.goal_amount_eur = 10000000;
+        project_create.min_pledge      = 0;
+        project_create.max_pledge      = 10000000;
+    do_op(project_create);
+
+    das33_project_object project = get_das33_projects()[0];
+
+    das33_project_update_operation project_update;
+        project_update.project_id = project.id;
+        project_update.authority  = get_das33_administrator_id();
+        project_update.status     = das33_project_status::active;
+    do_op(project_update);
+
+    const auto& pledge_idx = db.get_index_type<das33_pledge_holder_index>();
+    const auto& totals = dynamic_cast<const primary_index<das33_pledge_holder_index>&>(pledge_idx).get_secondary_index<das33_pledge_totals_index>();
+
+    // Compare the running totals with a scan over the pledges which still exist
+    const auto check_totals = [&](share_type phase) {
+      share_type base_in_phase = 0;
+      share_type pledged = 0;
+      for (const auto& pledge : get_das33_pledges())
+      {
+        if (pledge.phase_number == phase)
+          base_in_phase += pledge.base_expected.amount;
+        pledged += pledge.pledged.amount;
+      }
+      BOOST_CHECK_EQUAL(totals.base_expected_in_round(user_id, project.id, phase).value, base_in_phase.value);
+
+      const auto* assets = totals.find_project_assets(project.id);
+      if (pledged == 0)
+        BOOST_CHECK(assets == nullptr);
+      else
+      {
+        BOOST_REQUIRE(assets != nullptr);
+        BOOST_CHECK_EQUAL(assets->size(), 1);
+        BOOST_CHECK_EQUAL(assets->at(get_dascoin_asset_id()).pledged.value, pledged.value);
+      }
+    };
+
+    check_totals(0);
+
+    do_op_no_balance_check(das33_pledge_asset_operation(user_id, asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()}, optional<license_type_id_type>{}, project.id));
+    do_op_no_balance_check(das33_pledge_asset_operation(user_id, asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()}, optional<license_type_id_type>{}, project.id));
+    do_op_no_balance_check(das33_pledge_asset_operation(user_id, asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()}, optional<license_type_id_type>{}, project.id));
+    check_totals(0);
+    BOOST_CHECK_GT(totals.base_expected_in_round(user_id, project.id, 0).value, 0);
+
+    // Rejected pledges leave the totals
+    do_op_no_balance_check(das33_pledge_reject_operation(get_das33_administrator_id(), get_das33_pledges()[0].id));
+    check_totals(0);
+
+    // Rolling a removal back puts the pledge back into the totals
+    const share_type base_before = totals.base_expected_in_round(user_id, project.id, 0);
+    {
+      auto session = db._undo_db.start_undo_session();
+      db.remove(get_das33_pledges()[0]);
+      check_totals(0);
+      BOOST_CHECK_LT(totals.base_expected_in_round(user_id, project.id, 0).value, base_before.value);
+    }
+    check_totals(0);
+    BOOST_CHECK_EQUAL(totals.base_expected_in_round(user_id, project.id, 0).value, base_before.value);
+
+    // Move to phase 1 and pledge again
+    das33_project_update_operation project_update_phase;
+        project_update_phase.project_id = project.id;
+        project_update_phase.authority  = get_das33_administrator_id();
+        project_update_phase.phase_number = 1;
+    do_op_no_balance_check(project_update_phase);
+
+    do_op_no_balance_check(das33_pledge_asset_operation(user_id, asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()}, optional<license_type_id_type>{}, project.id));
+    check_totals(0);
+    check_totals(1);
+
+    graphene::app::database_api db_api(db);
+    const auto by_account = db_api.get_das33_pledges_by_account(user_id);
+    BOOST_CHECK_EQUAL(by_account.pledges.size(), 3);
+    BOOST_CHECK_EQUAL(by_account.base_expected_in_last_round.at(project.id).value,
+                      totals.base_expected_in_round(user_id, project.id, 1).value);
+
+    // Partial distribution keeps the pledge and its totals, full distribution removes both
+    do_op_no_balance_check(das33_distribute_project_pledges_operation(get_das33_administrator_id(), project.id, 0, 5000, 5000, 5000));
+    check_totals(0);
+    do_op_no_balance_check(das33_distribute_project_pledges_operation(get_das33_administrator_id(), project.id, 0, 10000, 10000, 10000));
+    check_totals(0);
+    BOOST_CHECK_EQUAL(totals.base_expected_in_round(user_id, project.id, 0).value, 0);
+    check_totals(1);
+
+    do_op_no_balance_check(das33_project_reject_operation(get_das33_administrator_id(), project.id));
+    check_totals(1);
+    BOOST_CHECK(totals.find_user_rounds(user_id) == nullptr);
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( external_btc_price_not_set_by_token_price_test )
+{ try {
+
+    const price oracle_price = asset(1 * DASCOIN_BITCOIN_PRECISION, get_btc_asset_id()) / asset(10000 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id());
+    set_external_btc_price(oracle_price);
+    BOOST_CHECK( db.get_external_btc_price() == oracle_price );
+
+    // A token price update for BTC is kept in the external price object and leaves the oracle price alone
+    update_external_token_price_operation op;
+    op.issuer = get_webasset_issuer_id();
+    op.token_id = get_btc_asset_id();
+    op.eur_amount_per_token = asset(1 * DASCOIN_BITCOIN_PRECISION, get_btc_asset_id()) / asset(20000 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id());
+    do_op(op);
+
+    BOOST_CHECK( db.get_external_btc_price() == oracle_price );
+    BOOST_REQUIRE( db.find_external_price(get_btc_asset_id(), get_web_asset_id()) != nullptr );
+    BOOST_CHECK( db.find_external_price(get_btc_asset_id(), get_web_asset_id())->external_price == op.eur_amount_per_token );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::das33_tests
 BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
 
@@ -398,10 +398,9 @@ BOOST_AUTO_TEST_CASE( daspay_debit_test )
   // Debit one web euro:
   do_op(daspay_debit_account_operation(payment1_id, pk1, foo_id, asset{1 * DASCOIN_FIAT_ASSET_PRECISION, db.get_web_asset_id()}, clearing1_id, "", {}));
 
-  const auto& dgpo = db.get_dynamic_global_properties();
   share_type debit_amount_with_fee = 1 * DASCOIN_FIAT_ASSET_PRECISION;
   debit_amount_with_fee += debit_amount_with_fee * db.get_dynamic_global_properties().daspay_debit_transaction_ratio / 10000;
-  const auto& debit_amount = asset{debit_amount_with_fee, db.get_web_asset_id()} * dgpo.last_dascoin_price;
+  const auto& debit_amount = asset{debit_amount_with_fee, db.get_web_asset_id()} * db.get_last_dascoin_price();
 
   BOOST_CHECK_EQUAL( get_dascoin_balance(clearing1_id), debit_amount.amount.value );
 
@@ -482,10 +481,9 @@ BOOST_AUTO_TEST_CASE( daspay_credit_test )
   // Credit one web euro:
   do_op(daspay_credit_account_operation(payment_id, foo_id, asset{1 * DASCOIN_FIAT_ASSET_PRECISION, db.get_web_asset_id()}, clearing_id, "", {}));
 
-  const auto& dgpo = db.get_dynamic_global_properties();
   share_type credit_amount_with_fee = 1 * DASCOIN_FIAT_ASSET_PRECISION;
   credit_amount_with_fee += credit_amount_with_fee * db.get_dynamic_global_properties().daspay_credit_transaction_ratio / 10000;
-  const auto& credit_amount = asset{credit_amount_with_fee, db.get_web_asset_id()} * dgpo.last_dascoin_price;
+  const auto& credit_amount = asset{credit_amount_with_fee, db.get_web_asset_id()} * db.get_last_dascoin_price();
 
   BOOST_CHECK_EQUAL( get_reserved_balance(foo_id, get_dascoin_asset_id()), credit_amount.amount.value );
 
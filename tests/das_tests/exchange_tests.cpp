@@ -264,8 +264,7 @@ BOOST_AUTO_TEST_CASE( exchange_test )
     check_balances(alicew, 900, 100);
     BOOST_CHECK_EQUAL( get_balance(bobw_id, get_dascoin_asset_id()), 90 * DASCOIN_DEFAULT_ASSET_PRECISION );
 
-    const auto &dgpo = get_dynamic_global_properties();
-    const auto &dprice = dgpo.last_dascoin_price;
+    const price dprice = db.get_last_dascoin_price();
     const price expected_price{ asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()},
                                 asset{1 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id()} };
     BOOST_CHECK( dprice == expected_price );
@@ -274,8 +273,7 @@ BOOST_AUTO_TEST_CASE( exchange_test )
                       asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()});
     create_sell_order(bobw_id, asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()},
                       asset{2 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id()});
-    const auto &dgpo2 = get_dynamic_global_properties();
-    const auto &dprice2 = dgpo2.last_dascoin_price;
+    const price dprice2 = db.get_last_dascoin_price();
     const price expected_price2{ asset{10 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()},
                                  asset{2 * DASCOIN_FIAT_ASSET_PRECISION, get_web_asset_id()}};
     BOOST_CHECK( dprice2 == expected_price2 );
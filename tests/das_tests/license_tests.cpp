@@ -30,7 +30,9 @@
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/frequency_history_record_object.hpp>
+#include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/license_objects.hpp>
+#include <graphene/chain/maintenance_task_object.hpp>
 #include <graphene/chain/upgrade_event_object.hpp>
 
 #include "../common/database_fixture.hpp"
@@ -630,6 +632,93 @@ BOOST_AUTO_TEST_CASE( upgrade_cycles_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( spread_upgrades_by_name_test )
+{ try {
+  generate_blocks(HARDFORK_MAINTENANCE_TASKS_TIME);
+
+  // Created in the reverse order of their names:
+  VAULT_ACTOR(zed);
+  VAULT_ACTOR(bob);
+  VAULT_ACTOR(alice);
+
+  auto standard_locked = *(_dal.get_license_type("standard_locked"));
+  const time_point_sec issue_time = db.head_block_time();
+  const auto& dgpo = db.get_dynamic_global_properties();
+  for ( const auto& id : {zed_id, bob_id, alice_id} )
+    do_op(issue_license_operation(get_license_issuer_id(), id, standard_locked.id, 0, 100, issue_time));
+
+  // Upgrade a single account per block:
+  const auto& task = db.create<maintenance_task_object>([](maintenance_task_object& mto){
+    mto.kind = maintenance_task_kind::perform_upgrades;
+    mto.budget_per_block = 1;
+  });
+
+  do_op(create_upgrade_event_operation(get_license_administrator_id(), dgpo.next_maintenance_time, {}, {}, "foo"));
+  generate_blocks(dgpo.next_maintenance_time);
+  BOOST_CHECK( task.running() );
+
+  // The accounts are walked by name, not by id:
+  const auto& accounts_by_name = db.get_index_type<account_index>().indices().get<by_name>();
+  BOOST_CHECK_EQUAL( task.name_cursor, std::next(accounts_by_name.begin())->name );
+
+  // One account is upgraded per block, note the order:
+  vector<string> upgraded;
+  while ( true )
+  {
+    for ( const auto& id : {zed_id, bob_id, alice_id} )
+    {
+      const auto& name = id(db).name;
+      if ( get_cycle_balance(id).value == 2 * DASCOIN_BASE_STANDARD_CYCLES &&
+           std::find(upgraded.begin(), upgraded.end(), name) == upgraded.end() )
+        upgraded.push_back(name);
+    }
+    if ( !task.running() )
+      break;
+    generate_block();
+  }
+  BOOST_CHECK( upgraded == vector<string>({"alice", "bob", "zed"}) );
+  BOOST_CHECK( task.name_cursor.empty() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( spread_upgrades_skip_new_accounts_test )
+{ try {
+  generate_blocks(HARDFORK_MAINTENANCE_TASKS_TIME);
+
+  VAULT_ACTOR(alice);
+
+  auto standard_locked = *(_dal.get_license_type("standard_locked"));
+  const time_point_sec issue_time = db.head_block_time();
+  const auto& dgpo = db.get_dynamic_global_properties();
+  do_op(issue_license_operation(get_license_issuer_id(), alice_id, standard_locked.id, 0, 100, issue_time));
+
+  // Upgrade a single account per block:
+  const auto& task = db.create<maintenance_task_object>([](maintenance_task_object& mto){
+    mto.kind = maintenance_task_kind::perform_upgrades;
+    mto.budget_per_block = 1;
+  });
+
+  do_op(create_upgrade_event_operation(get_license_administrator_id(), dgpo.next_maintenance_time, {}, {}, "foo"));
+  generate_blocks(dgpo.next_maintenance_time);
+  BOOST_REQUIRE( task.running() );
+
+  // Registered in the middle of the run, with a name still ahead of the cursor and a license from before the cutoff:
+  VAULT_ACTOR(zed);
+  do_op(issue_license_operation(get_license_issuer_id(), zed_id, standard_locked.id, 0, 100, issue_time));
+  BOOST_REQUIRE( task.running() );
+  BOOST_CHECK( task.name_cursor < "zed" );
+  BOOST_CHECK( !( object_id_type(zed_id) < task.first_new_id ) );
+
+  while ( task.running() )
+    generate_block();
+
+  // Only the accounts which existed when the upgrade event fired are upgraded:
+  BOOST_CHECK_EQUAL( get_cycle_balance(alice_id).value, 2 * DASCOIN_BASE_STANDARD_CYCLES );
+  BOOST_CHECK_EQUAL( get_cycle_balance(zed_id).value, DASCOIN_BASE_STANDARD_CYCLES );
+  BOOST_CHECK( task.first_new_id == object_id_type() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( upgrade_president_cycles_test )
 { try {
   VAULT_ACTOR(foo);
@@ -26,8 +26,11 @@
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/access_layer.hpp>
 #include <graphene/chain/exceptions.hpp>
+#include <graphene/chain/hardfork.hpp>
 
+#include <graphene/chain/dascoin_twap_object.hpp>
 #include <graphene/chain/license_objects.hpp>
+#include <graphene/chain/maintenance_task_object.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -156,6 +159,45 @@ BOOST_AUTO_TEST_CASE( set_next_spend_limit_reset_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( spread_spending_limit_reset_test )
+{ try {
+  VAULT_ACTORS((first)(second)(third))
+
+  // After the hardfork the first reset creates the task and finishes within its budget:
+  generate_blocks(HARDFORK_MAINTENANCE_TASKS_TIME);
+  const auto& idx = db.get_index_type<maintenance_task_index>().indices().get<by_kind>();
+  auto task_it = idx.find(maintenance_task_kind::reset_spending_limits);
+  BOOST_REQUIRE( task_it != idx.end() );
+  const maintenance_task_object& task = *task_it;
+  BOOST_CHECK( !task.running() );
+
+  // Reset a single account per block:
+  db.modify(task, [](maintenance_task_object& mto){
+    mto.budget_per_block = 1;
+  });
+  const auto num_accounts = db.get_index_type<account_index>().indices().size();
+
+  generate_blocks(db.get_dynamic_global_properties().next_spend_limit_reset);
+  BOOST_CHECK( task.running() );
+  BOOST_CHECK_EQUAL( task.processed, 1u );
+  BOOST_CHECK_EQUAL( task.started_at_block, db.head_block_num() );
+  const price run_price = db.get_dynamic_global_properties().last_daily_dascoin_price;
+  BOOST_CHECK( task.run_price == run_price );
+
+  // The reset is not triggered again while running and finishes after one block per account:
+  generate_blocks(static_cast<uint32_t>(num_accounts - 2));
+  BOOST_CHECK( task.running() );
+  BOOST_CHECK_EQUAL( task.processed, num_accounts - 1 );
+  // The run keeps the price it started with:
+  BOOST_CHECK( task.run_price == run_price );
+
+  generate_block();
+  BOOST_CHECK( !task.running() );
+  BOOST_CHECK_EQUAL( task.processed, 0u );
+  BOOST_CHECK( task.cursor == object_id_type() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( get_dascoin_limit_unit_test )
 { try {
   const share_type WEB_AMOUNT = 10 * DASCOIN_FIAT_ASSET_PRECISION;
@@ -219,7 +261,7 @@ BOOST_AUTO_TEST_CASE( limit_reset_test )
   auto& dgp = db.get_dynamic_global_properties();
   const asset ADVOCATE_EUR_LIMIT = 
     {_dal.get_license_type("no_license")->eur_limit, get_web_asset_id()};
-  share_type expected_limit = (ADVOCATE_EUR_LIMIT * dgp.last_dascoin_price).amount;
+  share_type expected_limit = (ADVOCATE_EUR_LIMIT * db.get_last_dascoin_price()).amount;
 
   // Check if limit is properly set:
   const auto& balance_start = db.get_balance_object(vault_id, DASCOIN_ASSET_ID);
@@ -246,26 +288,103 @@ BOOST_AUTO_TEST_CASE( daily_dascoin_price_test )
   const auto WEBEUR_ID = get_web_asset_id();
 
   BOOST_CHECK_EQUAL(
-    db.get_dynamic_global_properties().last_dascoin_price.to_real(),
+    db.get_last_dascoin_price().to_real(),
     db.get_dynamic_global_properties().last_daily_dascoin_price.to_real()
   );
   
   set_last_dascoin_price(asset(1, DSC_ID) / asset(999999, WEBEUR_ID));
 
   BOOST_CHECK_NE(
-    db.get_dynamic_global_properties().last_dascoin_price.to_real(),
+    db.get_last_dascoin_price().to_real(),
     db.get_dynamic_global_properties().last_daily_dascoin_price.to_real()
   );
 
   generate_blocks(db.head_block_time() + fc::hours(24) + fc::seconds(1));
 
   BOOST_CHECK_EQUAL(
-    db.get_dynamic_global_properties().last_dascoin_price.to_real(),
+    db.get_last_dascoin_price().to_real(),
     db.get_dynamic_global_properties().last_daily_dascoin_price.to_real()
   );
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( dascoin_twap_unit_test )
+{ try {
+  const fc::time_point_sec start( 1000 * DASCOIN_TWAP_BUCKET_SECONDS );
+  db.update_dascoin_twap_price();
+  const dascoin_twap_object& twap = *db.get_index_type<dascoin_twap_index>().indices().begin();
+  const auto& buckets = db.get_index_type<dascoin_twap_bucket_index>().indices();
+  db.modify(twap, [start](dascoin_twap_object& dto){
+    dto.last_price = 100;
+    dto.last_update = start;
+  });
+  const auto record = [&](fc::time_point_sec now, uint64_t price){
+    db.accrue_dascoin_twap(now);
+    db.modify(twap, [price](dascoin_twap_object& dto){ dto.last_price = price; });
+  };
+
+  // 100 for one period, 300 for the next one:
+  record(start + DASCOIN_TWAP_BUCKET_SECONDS, 300);
+  db.accrue_dascoin_twap(start + 2 * DASCOIN_TWAP_BUCKET_SECONDS);
+  BOOST_CHECK_EQUAL( twap.window_seconds, 2u * DASCOIN_TWAP_BUCKET_SECONDS );
+  BOOST_CHECK_EQUAL( twap.average(), 200u );
+  // Only the buckets of the periods covered exist:
+  BOOST_CHECK_EQUAL( buckets.size(), 2u );
+
+  // A spike within a single block carries no weight:
+  record(start + 2 * DASCOIN_TWAP_BUCKET_SECONDS, 1000000);
+  record(start + 2 * DASCOIN_TWAP_BUCKET_SECONDS, 300);
+  db.accrue_dascoin_twap(start + 2 * DASCOIN_TWAP_BUCKET_SECONDS + 1);
+  BOOST_CHECK_EQUAL( twap.average(), (100u * DASCOIN_TWAP_BUCKET_SECONDS + 300u * (DASCOIN_TWAP_BUCKET_SECONDS + 1))
+                                     / (2u * DASCOIN_TWAP_BUCKET_SECONDS + 1) );
+  BOOST_CHECK_EQUAL( buckets.size(), 3u );
+
+  // Once the first period leaves the window, only 300 remains:
+  db.accrue_dascoin_twap(start + DASCOIN_TWAP_BUCKET_COUNT * DASCOIN_TWAP_BUCKET_SECONDS + DASCOIN_TWAP_BUCKET_SECONDS);
+  BOOST_CHECK_EQUAL( twap.average(), 300u );
+  BOOST_CHECK_EQUAL( twap.window_seconds, uint64_t(DASCOIN_TWAP_BUCKET_COUNT) * DASCOIN_TWAP_BUCKET_SECONDS );
+  BOOST_CHECK_EQUAL( buckets.size(), size_t(DASCOIN_TWAP_BUCKET_COUNT) );
+
+  // A gap longer than the window is covered by the last price alone, the new price starts a new period:
+  record(start + 10 * DASCOIN_TWAP_BUCKET_COUNT * DASCOIN_TWAP_BUCKET_SECONDS, 500);
+  db.accrue_dascoin_twap(start + 10 * DASCOIN_TWAP_BUCKET_COUNT * DASCOIN_TWAP_BUCKET_SECONDS + 10);
+  const uint64_t covered = uint64_t(DASCOIN_TWAP_BUCKET_COUNT - 1) * DASCOIN_TWAP_BUCKET_SECONDS;
+  BOOST_CHECK_EQUAL( twap.window_seconds, covered + 10 );
+  BOOST_CHECK_EQUAL( twap.window_weighted_sum, covered * 300 + 10 * 500 );
+  BOOST_CHECK_EQUAL( buckets.size(), size_t(DASCOIN_TWAP_BUCKET_COUNT) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( dascoin_twap_spending_limit_test )
+{ try {
+  const auto DSC_ID = get_dascoin_asset_id();
+  const auto WEBEUR_ID = get_web_asset_id();
+  const asset ONE_EUR{1 * DASCOIN_FIAT_ASSET_PRECISION, WEBEUR_ID};
+
+  // 10 DSC per WebEUR:
+  set_last_dascoin_price(asset(10 * DASCOIN_DEFAULT_ASSET_PRECISION, DSC_ID) / ONE_EUR);
+  generate_blocks(HARDFORK_DASCOIN_TWAP_TIME);
+  generate_blocks(db.get_dynamic_global_properties().next_spend_limit_reset);
+
+  // The first reset after the hardfork starts the average at the last price:
+  const auto& idx = db.get_index_type<dascoin_twap_index>().indices();
+  BOOST_REQUIRE_EQUAL( idx.size(), 1u );
+  const dascoin_twap_object& twap = *idx.begin();
+  BOOST_CHECK_EQUAL( twap.last_price, 10 * DASCOIN_DEFAULT_ASSET_PRECISION );
+  BOOST_CHECK( db.get_dynamic_global_properties().last_daily_dascoin_price == db.get_last_dascoin_price() );
+
+  // A trade at 20 DSC per WebEUR only moves the daily price by the share of the window it was in effect:
+  generate_blocks(db.head_block_time() + fc::hours(1));
+  db.record_dascoin_twap_price(asset(20 * DASCOIN_DEFAULT_ASSET_PRECISION, DSC_ID), ONE_EUR);
+  generate_blocks(db.get_dynamic_global_properties().next_spend_limit_reset);
+  const uint64_t average = twap.average();
+  BOOST_CHECK_GT( average, 10 * DASCOIN_DEFAULT_ASSET_PRECISION );
+  BOOST_CHECK_LT( average, 20 * DASCOIN_DEFAULT_ASSET_PRECISION );
+  BOOST_CHECK( db.get_dynamic_global_properties().last_daily_dascoin_price
+               == dascoin_twap_object::from_twap_price(average, DSC_ID, WEBEUR_ID) );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( obey_limit_test )
 { try {
   ACTOR(wallet);
@@ -379,8 +498,7 @@ BOOST_AUTO_TEST_CASE( get_vault_info_unit_test )
   BOOST_CHECK_EQUAL( res->spent.value, 0 );
   BOOST_CHECK( !res->license_information.valid() );
 
-  const auto& dgpo = db.get_dynamic_global_properties();
-  const auto& dascoin_price = dgpo.last_dascoin_price;
+  const price dascoin_price = db.get_last_dascoin_price();
   asset dascoin_limit = asset{DASCOIN_DEFAULT_EUR_LIMIT_ADVOCATE, db.get_web_asset_id()} * dascoin_price;
 
   BOOST_CHECK_EQUAL( res->dascoin_limit.value, dascoin_limit.amount.value );
@@ -23,10 +23,45 @@
  */
 #include <cstdlib>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 #include <boost/test/included/unit_test.hpp>
 
 extern uint32_t GRAPHENE_TESTING_GENESIS_TIMESTAMP;
 
+using namespace boost::unit_test;
+
+/**
+ * Collects the test cases that do not belong to this process' shard. Cases are dealt round robin in test tree
+ * order, so every process given the same shard count agrees on the split.
+ */
+struct shard_filter : test_tree_visitor
+{
+   shard_filter( uint32_t index, uint32_t count ) : index(index), count(count) {}
+
+   void visit( const test_case& tc ) override
+   {
+      if( seen++ % count != index )
+         excluded.emplace_back( suites.back(), test_unit_id( tc.p_id ) );
+   }
+   bool test_suite_start( const test_suite& ts ) override
+   {
+      suites.push_back( ts.p_id );
+      return true;
+   }
+   void test_suite_finish( const test_suite& ) override
+   {
+      suites.pop_back();
+   }
+
+   uint32_t index;
+   uint32_t count;
+   uint32_t seen = 0;
+   std::vector<test_unit_id> suites;
+   std::vector<std::pair<test_unit_id, test_unit_id>> excluded;
+};
+
 boost::unit_test::test_suite* init_unit_test_suite(int argc, char* argv[]) {
    std::srand(time(NULL));
    std::cout << "Random number generator seeded to " << time(NULL) << std::endl;
@@ -36,5 +71,21 @@ boost::unit_test::test_suite* init_unit_test_suite(int argc, char* argv[]) {
       GRAPHENE_TESTING_GENESIS_TIMESTAMP = std::stoul( genesis_timestamp_str );
    }
    std::cout << "GRAPHENE_TESTING_GENESIS_TIMESTAMP is " << GRAPHENE_TESTING_GENESIS_TIMESTAMP << std::endl;
+
+   const char* shard_index_str = getenv("DAS_TEST_SHARD_INDEX");
+   const char* shard_count_str = getenv("DAS_TEST_SHARD_COUNT");
+   if( shard_index_str != nullptr && shard_count_str != nullptr )
+   {
+      const uint32_t shard_count = std::stoul( shard_count_str );
+      const uint32_t shard_index = std::stoul( shard_index_str );
+      if( shard_count == 0 || shard_index >= shard_count )
+         throw framework::setup_error( "DAS_TEST_SHARD_INDEX must be less than a non-zero DAS_TEST_SHARD_COUNT" );
+      shard_filter filter( shard_index, shard_count );
+      traverse_test_tree( framework::master_test_suite(), filter );
+      for( const auto& e : filter.excluded )
+         framework::get<test_suite>( e.first ).remove( e.second );
+      std::cout << "Running shard " << shard_index << " of " << shard_count << ", "
+                << filter.seen - filter.excluded.size() << " of " << filter.seen << " test cases" << std::endl;
+   }
    return nullptr;
 }
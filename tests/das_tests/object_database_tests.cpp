@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/db/object_database.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <fstream>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+  vector<account_balance_object> make_balances( uint64_t count )
+  {
+    vector<account_balance_object> balances( count );
+    for( uint64_t i = 0; i < count; ++i )
+    {
+      balances[i].id = object_id_type( account_balance_object::space_id, account_balance_object::type_id, i );
+      balances[i].owner = account_id_type( 100 + i );
+      balances[i].balance = 1000 * (i + 1);
+    }
+    return balances;
+  }
+
+  void check_balances( const graphene::db::index& idx, const vector<account_balance_object>& balances )
+  {
+    for( const auto& expected : balances )
+    {
+      const auto* found = dynamic_cast<const account_balance_object*>( idx.find( expected.id ) );
+      BOOST_REQUIRE( found != nullptr );
+      BOOST_CHECK( found->owner == expected.owner );
+      BOOST_CHECK_EQUAL( found->balance.value, expected.balance.value );
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( object_database_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( legacy_index_file_test )
+{ try {
+  fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+  const auto balances = make_balances( 5 );
+  const object_id_type next_id = balances.back().id + 1;
+
+  // The 1.0 format has no count, every object is packed into a blob of its own; write them out of order:
+  const fc::path legacy_file = dir.path() / "legacy";
+  {
+    std::ofstream out( legacy_file.generic_string(), std::ofstream::binary );
+    fc::raw::pack( out, next_id );
+    fc::raw::pack( out, fc::sha256::hash( std::string( "1.0" ) ) );
+    for( auto itr = balances.rbegin(); itr != balances.rend(); ++itr )
+      fc::raw::pack( out, fc::raw::pack( *itr ) );
+  }
+
+  graphene::db::object_database legacy_db;
+  auto* legacy_idx = legacy_db.add_index< primary_index<account_balance_index> >();
+  legacy_idx->open( legacy_file );
+  BOOST_CHECK( legacy_idx->get_next_id() == next_id );
+  check_balances( *legacy_idx, balances );
+
+  // Saving writes the counted format, which opens to the same objects:
+  const fc::path counted_file = dir.path() / "counted";
+  legacy_idx->save( counted_file );
+  graphene::db::object_database counted_db;
+  auto* counted_idx = counted_db.add_index< primary_index<account_balance_index> >();
+  counted_idx->open( counted_file );
+  BOOST_CHECK( counted_idx->get_next_id() == next_id );
+  check_balances( *counted_idx, balances );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( corrupt_index_count_test )
+{ try {
+  fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+  const fc::path file = dir.path() / "balances";
+  {
+    graphene::db::object_database odb;
+    auto* idx = odb.add_index< primary_index<account_balance_index> >();
+    for( const auto& b : make_balances( 3 ) )
+      odb.create<account_balance_object>( [&]( account_balance_object& obj ) {
+        obj.owner = b.owner;
+        obj.balance = b.balance;
+      });
+    idx->save( file );
+  }
+
+  // The count follows the next id and the version hash; claim far more objects than the file holds:
+  {
+    std::fstream f( file.generic_string(), std::ios::binary | std::ios::in | std::ios::out );
+    f.seekp( sizeof(uint64_t) + sizeof(fc::sha256) );
+    fc::raw::pack( f, uint64_t(1) << 40 );
+  }
+
+  graphene::db::object_database odb;
+  auto* idx = odb.add_index< primary_index<account_balance_index> >();
+  GRAPHENE_REQUIRE_THROW( idx->open( file ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // object_database_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
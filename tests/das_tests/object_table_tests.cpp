@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/db/object_table.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( object_table_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( object_table_lookup_test )
+{ try {
+  ACTOR(wallet);
+
+  BOOST_CHECK( db.find_object(wallet_id) == &wallet );
+  BOOST_CHECK( db.find_object(wallet.statistics) == &wallet.statistics(db) );
+  BOOST_CHECK( db.find_object(account_id_type(1000000)) == nullptr );
+
+  const auto& balance = db.create<account_balance_object>([&](account_balance_object& b) {
+    b.owner = wallet_id;
+    b.asset_type = asset_id_type(999);
+  });
+  const object_id_type balance_id = balance.id;
+  BOOST_CHECK( db.find_object(balance_id) == &balance );
+
+  {
+    auto session = db._undo_db.start_undo_session();
+    db.remove(balance);
+    BOOST_CHECK( db.find_object(balance_id) == nullptr );
+    session.undo();
+  }
+
+  // Undo puts the object back in the table as well:
+  const auto* restored = db.find<account_balance_object>(balance_id);
+  BOOST_REQUIRE( restored != nullptr );
+  BOOST_CHECK( restored->owner == wallet_id );
+  BOOST_CHECK( restored == db.find_object(balance_id) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( object_table_page_release_test )
+{ try {
+  graphene::db::object_table table;
+  auto& types = table.track( 1, 2 );
+  const uint64_t page_size = graphene::db::object_table::page_size;
+
+  vector<account_balance_object> objects( 3 * page_size );
+  for( uint64_t i = 0; i < objects.size(); ++i )
+    types.set( i, &objects[i] );
+  BOOST_CHECK_EQUAL( types.allocated_pages(), 3u );
+
+  // A page stays while any of its objects is alive:
+  for( uint64_t i = 0; i < page_size - 1; ++i )
+    types.set( i, nullptr );
+  BOOST_CHECK_EQUAL( types.allocated_pages(), 3u );
+  BOOST_CHECK( types.find( page_size - 1 ) == &objects[page_size - 1] );
+
+  types.set( page_size - 1, nullptr );
+  BOOST_CHECK_EQUAL( types.allocated_pages(), 2u );
+  BOOST_CHECK( types.find( page_size - 1 ) == nullptr );
+  BOOST_CHECK( types.find( page_size ) == &objects[page_size] );
+
+  // Clearing a slot twice does not release a page still in use:
+  types.set( 0, nullptr );
+  types.set( page_size, nullptr );
+  types.set( page_size, nullptr );
+  BOOST_CHECK_EQUAL( types.allocated_pages(), 2u );
+
+  for( uint64_t i = page_size; i < objects.size(); ++i )
+    types.set( i, nullptr );
+  BOOST_CHECK_EQUAL( types.allocated_pages(), 0u );
+  BOOST_CHECK( types.find( 2 * page_size ) == nullptr );
+
+  // A released page is allocated again for new ids:
+  types.set( 3 * page_size, &objects[0] );
+  BOOST_CHECK_EQUAL( types.allocated_pages(), 1u );
+  BOOST_CHECK( types.find( 3 * page_size ) == &objects[0] );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // object_table_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
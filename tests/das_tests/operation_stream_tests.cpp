@@ -0,0 +1,257 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/operation_stream/socket_forwarder.hpp>
+#include <graphene/operation_stream/stream_writer.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace graphene::chain;
+using namespace graphene::operation_stream;
+
+namespace {
+  block_record make_block( uint32_t num, const string& fork )
+  {
+    block_record block;
+    block.block_num = num;
+    block.block_id = block_id_type::hash( fork + std::to_string( num ) );
+    return block;
+  }
+
+  vector<stream_frame> read_all( const fc::temp_directory& dir, uint64_t after = 0 )
+  {
+    vector<stream_frame> frames;
+    stream_writer::read_frames( dir.path(), after, [&]( const stream_frame& f, const vector<char>& ) {
+      frames.push_back( f );
+    });
+    return frames;
+  }
+
+#ifndef WIN32
+  int listen_on( const std::string& path )
+  {
+    sockaddr_un addr;
+    std::memset( &addr, 0, sizeof(addr) );
+    addr.sun_family = AF_UNIX;
+    std::strncpy( addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1 );
+    const int fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+    FC_ASSERT( fd >= 0 );
+    FC_ASSERT( ::bind( fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr) ) == 0 );
+    FC_ASSERT( ::listen( fd, 1 ) == 0 );
+    return fd;
+  }
+
+  int accept_consumer( int listener )
+  {
+    const int fd = ::accept( listener, nullptr, nullptr );
+    FC_ASSERT( fd >= 0 );
+    // Fail the test instead of hanging when frames never arrive
+    timeval timeout{ 5, 0 };
+    ::setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout) );
+    return fd;
+  }
+
+  void read_exactly( int fd, char* data, size_t size )
+  {
+    size_t got = 0;
+    while( got < size )
+    {
+      const auto n = ::recv( fd, data + got, size - got, 0 );
+      FC_ASSERT( n > 0, "consumer socket closed or timed out" );
+      got += n;
+    }
+  }
+
+  vector<uint64_t> receive_sequences( int fd, size_t count )
+  {
+    vector<uint64_t> sequences;
+    while( sequences.size() < count )
+    {
+      unsigned char prefix[4];
+      read_exactly( fd, reinterpret_cast<char*>(prefix), sizeof(prefix) );
+      const uint32_t size = prefix[0] | prefix[1] << 8 | prefix[2] << 16 | uint32_t(prefix[3]) << 24;
+      vector<char> packed( size );
+      read_exactly( fd, packed.data(), size );
+      sequences.push_back( fc::raw::unpack<stream_frame>( packed ).sequence );
+    }
+    return sequences;
+  }
+
+  void stream_block( stream_writer& writer, socket_forwarder& forwarder, const block_record& block )
+  {
+    const uint64_t first_sequence = writer.last_sequence() + 1;
+    auto framed = writer.write_block( block );
+    forwarder.push( std::move( framed ), first_sequence, writer.last_sequence() );
+  }
+#endif
+
+  bool is_undo_of( const stream_frame& f, const block_record& block )
+  {
+    return f.record.which() == stream_record::tag<undo_record>::value
+        && f.record.get<undo_record>().block_num == block.block_num
+        && f.record.get<undo_record>().block_id == block.block_id;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( dascoin_tests )
+BOOST_AUTO_TEST_SUITE( operation_stream_tests )
+
+BOOST_AUTO_TEST_CASE( stream_writer_fork_test )
+{ try {
+  fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+  {
+    stream_writer writer( dir.path(), 1024 * 1024 );
+
+    auto b1 = make_block( 1, "a" );
+    transfer_operation op;
+    op.from = account_id_type(10);
+    op.to = account_id_type(11);
+    streamed_operation sop;
+    sop.op = op;
+    sop.impacted.insert( op.from );
+    sop.impacted.insert( op.to );
+    b1.operations.push_back( sop );
+
+    BOOST_CHECK( !writer.write_block( b1 ).empty() );
+    BOOST_CHECK( !writer.write_block( make_block( 2, "a" ) ).empty() );
+    BOOST_CHECK( !writer.write_block( make_block( 3, "a" ) ).empty() );
+    BOOST_CHECK_EQUAL( writer.last_sequence(), 3 );
+
+    // Replaying a block that was streamed already writes nothing:
+    BOOST_CHECK( writer.write_block( make_block( 2, "a" ) ).empty() );
+    BOOST_CHECK_EQUAL( writer.last_sequence(), 3 );
+
+    // Switching forks undoes the popped block before the new one:
+    BOOST_CHECK( !writer.write_block( make_block( 3, "b" ) ).empty() );
+    BOOST_CHECK_EQUAL( writer.last_sequence(), 5 );
+
+    const auto frames = read_all( dir );
+    BOOST_REQUIRE_EQUAL( frames.size(), 5 );
+    BOOST_CHECK( is_undo_of( frames[3], make_block( 3, "a" ) ) );
+    BOOST_CHECK( frames[4].record.get<block_record>().block_id == make_block( 3, "b" ).block_id );
+    const auto& streamed = frames[0].record.get<block_record>().operations;
+    BOOST_REQUIRE_EQUAL( streamed.size(), 1 );
+    BOOST_CHECK( streamed[0].op.get<transfer_operation>().to == account_id_type(11) );
+    BOOST_CHECK_EQUAL( streamed[0].impacted.size(), 2 );
+
+    BOOST_CHECK_EQUAL( read_all( dir, 3 ).size(), 2 );
+  }
+
+  // A reopened writer continues the sequence and still knows which blocks it streamed:
+  stream_writer writer( dir.path(), 1024 * 1024 );
+  BOOST_CHECK_EQUAL( writer.last_sequence(), 5 );
+  BOOST_CHECK( writer.write_block( make_block( 3, "b" ) ).empty() );
+  writer.write_block( make_block( 2, "c" ) );
+  const auto frames = read_all( dir, 5 );
+  BOOST_REQUIRE_EQUAL( frames.size(), 3 );
+  BOOST_CHECK( is_undo_of( frames[0], make_block( 3, "b" ) ) );
+  BOOST_CHECK( is_undo_of( frames[1], make_block( 2, "a" ) ) );
+  BOOST_CHECK_EQUAL( frames[2].sequence, 8 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( stream_writer_checkpoint_test )
+{ try {
+  fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+  // Every block gets its own segment:
+  stream_writer writer( dir.path(), 1 );
+  for( uint32_t num = 1; num <= 4; ++num )
+    writer.write_block( make_block( num, "a" ) );
+
+  // Without a checkpoint nothing is removed:
+  writer.write_block( make_block( 5, "a" ) );
+  BOOST_CHECK_EQUAL( read_all( dir ).front().sequence, 1 );
+
+  // Segments holding only consumed frames are removed on the next rotation:
+  {
+    std::ofstream checkpoint( ( dir.path() / "checkpoint" ).string() );
+    checkpoint << 3;
+  }
+  BOOST_CHECK_EQUAL( writer.read_checkpoint(), 3 );
+  writer.write_block( make_block( 6, "a" ) );
+  const auto frames = read_all( dir );
+  BOOST_REQUIRE_EQUAL( frames.size(), 3 );
+  BOOST_CHECK_EQUAL( frames.front().sequence, 4 );
+
+} FC_LOG_AND_RETHROW() }
+
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE( socket_forwarder_test )
+{ try {
+  fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+  const std::string socket_path = ( dir.path() / "consumer.sock" ).string();
+  const int listener = listen_on( socket_path );
+
+  stream_writer writer( dir.path(), 1024 * 1024 );
+  {
+    // A queue of one block overflows at once; the frames left out are sent from the segment files:
+    socket_forwarder forwarder( dir.path(), socket_path, 1, std::chrono::milliseconds( 10 ) );
+    for( uint32_t num = 1; num <= 5; ++num )
+      stream_block( writer, forwarder, make_block( num, "a" ) );
+
+    int consumer = accept_consumer( listener );
+    BOOST_CHECK( receive_sequences( consumer, 5 ) == vector<uint64_t>({ 1, 2, 3, 4, 5 }) );
+
+    // Frames pushed after the replay arrive in order, undo frames included:
+    stream_block( writer, forwarder, make_block( 5, "b" ) );
+    stream_block( writer, forwarder, make_block( 6, "b" ) );
+    BOOST_CHECK( receive_sequences( consumer, 3 ) == vector<uint64_t>({ 6, 7, 8 }) );
+
+    // A consumer that went away gets everything after its checkpoint once it is back:
+    {
+      std::ofstream checkpoint( ( dir.path() / "checkpoint" ).string() );
+      checkpoint << 6;
+    }
+    ::close( consumer );
+    stream_block( writer, forwarder, make_block( 7, "b" ) );
+    consumer = accept_consumer( listener );
+    BOOST_CHECK( receive_sequences( consumer, 3 ) == vector<uint64_t>({ 7, 8, 9 }) );
+    ::close( consumer );
+  }
+
+  // Stopping does not wait for a consumer that never shows up:
+  {
+    socket_forwarder forwarder( dir.path(), ( dir.path() / "nobody.sock" ).string(), 1, std::chrono::milliseconds( 10 ) );
+    stream_block( writer, forwarder, make_block( 8, "b" ) );
+    BOOST_CHECK_EQUAL( forwarder.sent_sequence(), 0 );
+  }
+  ::close( listener );
+
+} FC_LOG_AND_RETHROW() }
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()  // operation_stream_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
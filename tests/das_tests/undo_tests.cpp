@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <limits>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+
+BOOST_FIXTURE_TEST_SUITE( undo_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( segmented_undo_history_test )
+{ try {
+  ACTOR(wallet);
+  generate_block();
+
+  const auto& hist_idx = db.get_index_type<operation_history_index>();
+  const auto count_history = [&]() {
+    size_t n = 0;
+    hist_idx.inspect_all_objects([&](const object&) { ++n; });
+    return n;
+  };
+  const size_t history_before = count_history();
+  const auto next_id_before = hist_idx.get_next_id();
+
+  do_op(set_roll_back_enabled_operation(wallet_id, false));
+  generate_block();
+  BOOST_CHECK_GT( count_history(), history_before );
+
+  // Popping the block truncates the history it added, which was never part of its undo state:
+  db.pop_block();
+  BOOST_CHECK_EQUAL( count_history(), history_before );
+  BOOST_CHECK( hist_idx.get_next_id() == next_id_before );
+  BOOST_CHECK( db.find_object(next_id_before) == nullptr );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( undo_memory_limit_test )
+{ try {
+  ACTOR(wallet);
+  generate_block();
+  do_op(set_roll_back_enabled_operation(wallet_id, false));
+  generate_block();
+  BOOST_CHECK( !wallet.roll_back_enabled );
+
+  // Memory is measured only while there is a limit:
+  BOOST_CHECK_EQUAL( db._undo_db.get_stats().memory_usage, 0u );
+  db._undo_db.set_max_memory(std::numeric_limits<size_t>::max());
+  const auto before = db._undo_db.get_stats();
+  BOOST_CHECK_GT( before.memory_usage, 0u );
+  BOOST_CHECK_EQUAL( before.compacted_depth, 0u );
+
+  // A limit below what is held packs the committed states:
+  db._undo_db.set_max_memory(1);
+  const auto after = db._undo_db.get_stats();
+  BOOST_CHECK_GT( after.compacted_depth, 0u );
+  BOOST_CHECK_LT( after.memory_usage, before.memory_usage );
+
+  // Packed states are unpacked when undone:
+  db.pop_block();
+  BOOST_CHECK( wallet.roll_back_enabled );
+  db._undo_db.set_max_memory(0);
+  BOOST_CHECK_EQUAL( db._undo_db.get_stats().memory_usage, 0u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // undo_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
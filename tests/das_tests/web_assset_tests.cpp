@@ -222,6 +222,31 @@ BOOST_AUTO_TEST_CASE( check_issued_webeur_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( check_issued_webeurs_test )
+{ try {
+  ACTOR(wallet);
+
+  issue_webasset("NL1", wallet_id, 100, 100);
+  issue_webasset("NL3", wallet_id, 100, 100);
+
+  // Only the issued ids are returned, in the order given:
+  auto issued = _dal.check_issued_webeurs({"NL3", "NL2", "NL1", "FOO"});
+  BOOST_REQUIRE_EQUAL( issued.size(), 2u );
+  BOOST_CHECK_EQUAL( issued[0], "NL3" );
+  BOOST_CHECK_EQUAL( issued[1], "NL1" );
+
+  // Records are keyed by asset too:
+  issued = _dal.check_issued_assets({"NL1", "NL3"}, DASCOIN_CYCLE_ASSET_SYMBOL);
+  BOOST_CHECK( issued.empty() );
+  issued = _dal.check_issued_assets({"NL1", "NL3"}, DASCOIN_WEBASSET_SYMBOL);
+  BOOST_CHECK_EQUAL( issued.size(), 2u );
+
+  // Unknown assets have no issues:
+  issued = _dal.check_issued_assets({"NL1"}, "FOO");
+  BOOST_CHECK( issued.empty() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( check_unique_id_when_issueing_webeur_test )
 { try {
   ACTOR(wallet);